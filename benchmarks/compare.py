@@ -0,0 +1,60 @@
+"""
+Compares two result files written by Particles_benchmarks, and flags the benchmarks that got slower.
+
+    python benchmarks/compare.py baseline.json contender.json [--threshold 5] [--metric median_ns]
+
+Exits with code 1 if at least one benchmark regressed by more than the threshold (in percent), so it can be used in CI.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8") as file:
+        results = json.load(file)
+    return {(b["name"], b["size"]): b for b in results["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=5.0, help="In percent. Smaller differences are considered noise. Default: 5")
+    parser.add_argument("--metric", default="median_ns", choices=["median_ns", "min_ns", "mean_ns"], help="Default: median_ns")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    contender = load(args.contender)
+
+    regressions = 0
+    print(f"{'Benchmark':<48}{'Baseline':>16}{'Contender':>16}{'Change':>10}")
+    for key in sorted(baseline.keys() & contender.keys()):
+        before = baseline[key][args.metric]
+        after = contender[key][args.metric]
+        change = 100.0 * (after - before) / before
+        # Also require the difference to be bigger than the noise of both measurements
+        noise = 100.0 * (baseline[key]["stddev_ns"] + contender[key]["stddev_ns"]) / before
+        verdict = ""
+        if change > max(args.threshold, noise):
+            verdict = "  REGRESSION"
+            regressions += 1
+        elif change < -max(args.threshold, noise):
+            verdict = "  improvement"
+        name = f"{key[0]}/{key[1]}"
+        print(f"{name:<48}{before:>16.1f}{after:>16.1f}{change:>+9.1f}%{verdict}")
+
+    for key in sorted(baseline.keys() - contender.keys()):
+        print(f"{key[0]}/{key[1]}: only in the baseline")
+    for key in sorted(contender.keys() - baseline.keys()):
+        print(f"{key[0]}/{key[1]}: only in the contender")
+
+    if regressions > 0:
+        print(f"\n{regressions} regression(s) above {args.threshold}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,166 @@
+#include "harness.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+namespace bench {
+
+auto Result::median_ns() const -> double
+{
+    std::vector<double> sorted = ns_per_iteration;
+    std::sort(sorted.begin(), sorted.end());
+    size_t const middle = sorted.size() / 2;
+    return sorted.size() % 2 == 1 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2.;
+}
+
+auto Result::min_ns() const -> double
+{
+    return *std::min_element(ns_per_iteration.begin(), ns_per_iteration.end());
+}
+
+auto Result::mean_ns() const -> double
+{
+    return std::accumulate(ns_per_iteration.begin(), ns_per_iteration.end(), 0.) / static_cast<double>(ns_per_iteration.size());
+}
+
+auto Result::stddev_ns() const -> double
+{
+    double const mean     = mean_ns();
+    double       variance = 0.;
+    for (double const ns : ns_per_iteration)
+        variance += (ns - mean) * (ns - mean);
+    return std::sqrt(variance / static_cast<double>(ns_per_iteration.size()));
+}
+
+static auto measure(std::function<void()> const& code, size_t iterations) -> std::chrono::nanoseconds
+{
+    auto const begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+        code();
+    return std::chrono::steady_clock::now() - begin;
+}
+
+static auto run(Benchmark const& benchmark, size_t size, Options const& options) -> Result
+{
+    auto const code = benchmark.setup(size);
+
+    // Warm up, doubling the number of iterations until one batch is long enough to estimate the duration of an iteration
+    size_t                   iterations = 1;
+    std::chrono::nanoseconds elapsed    = measure(code, iterations);
+    std::chrono::nanoseconds total      = elapsed;
+    while (total < options.warm_up_time || elapsed < std::chrono::milliseconds{1})
+    {
+        iterations *= 2;
+        elapsed = measure(code, iterations);
+        total += elapsed;
+    }
+    double const estimated_ns = static_cast<double>(elapsed.count()) / static_cast<double>(iterations);
+
+    Result result{
+        .name       = benchmark.name,
+        .size       = size,
+        .iterations = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(std::chrono::nanoseconds{options.min_time}.count()) / estimated_ns)),
+    };
+    for (size_t repetition = 0; repetition < options.repetitions; ++repetition)
+        result.ns_per_iteration.push_back(static_cast<double>(measure(code, result.iterations).count()) / static_cast<double>(result.iterations));
+    return result;
+}
+
+auto run(std::vector<Benchmark> const& benchmarks, Options const& options) -> std::vector<Result>
+{
+    if (options.repetitions == 0)
+        throw std::invalid_argument{"There must be at least one repetition"};
+
+    std::cout << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(16) << "Median (ns)" << std::setw(14) << "ns / item" << std::setw(12) << "Std dev" << '\n';
+    std::vector<Result> results{};
+    for (Benchmark const& benchmark : benchmarks)
+    {
+        if (benchmark.name.find(options.filter) == std::string::npos)
+            continue;
+        for (size_t const size : benchmark.sizes)
+        {
+            Result const& result = results.emplace_back(run(benchmark, size, options));
+            std::cout << std::left << std::setw(48) << (result.name + '/' + std::to_string(result.size))
+                      << std::right << std::fixed << std::setprecision(1) << std::setw(16) << result.median_ns()
+                      << std::setprecision(3) << std::setw(14) << result.ns_per_item()
+                      << std::setprecision(1) << std::setw(11) << 100. * result.stddev_ns() / result.mean_ns() << "%\n";
+        }
+    }
+    return results;
+}
+
+static void write_json_string(std::ofstream& file, std::string_view string)
+{
+    file << '"';
+    for (char const c : string)
+    {
+        if (c == '"' || c == '\\')
+            file << '\\';
+        file << c;
+    }
+    file << '"';
+}
+
+static auto compiler() -> std::string
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+void save_json(std::vector<Result> const& results, Options const& options, std::filesystem::path const& path)
+{
+    auto file = std::ofstream{path};
+    if (!file)
+        throw std::runtime_error{"Failed to write the results to " + path.string()};
+
+    std::time_t const    now = std::time(nullptr);
+    std::array<char, 32> date{};
+    std::strftime(date.data(), date.size(), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now)); // NOLINT(concurrency-mt-unsafe)
+
+    file << std::setprecision(10);
+    file << "{\n  \"context\": {\n";
+    file << "    \"date\": \"" << date.data() << "\",\n";
+    file << "    \"compiler\": ";
+    write_json_string(file, compiler());
+    file << ",\n";
+#if defined(NDEBUG)
+    file << "    \"assertions\": false,\n";
+#else
+    file << "    \"assertions\": true,\n";
+#endif
+    file << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    file << "    \"repetitions\": " << options.repetitions << ",\n";
+    file << "    \"min_time_ms\": " << options.min_time.count() << "\n";
+    file << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        Result const& result = results[i];
+        file << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        write_json_string(file, result.name);
+        file << ", \"size\": " << result.size
+             << ", \"iterations\": " << result.iterations
+             << ", \"median_ns\": " << result.median_ns()
+             << ", \"min_ns\": " << result.min_ns()
+             << ", \"mean_ns\": " << result.mean_ns()
+             << ", \"stddev_ns\": " << result.stddev_ns()
+             << ", \"ns_per_item\": " << result.ns_per_item() << "}";
+    }
+    file << "\n  ]\n}\n";
+}
+
+} // namespace bench
@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// A minimal benchmark harness: each benchmark is run for several sizes, warmed up, then measured over several repetitions.
+namespace bench {
+
+/// Prevents the compiler from optimizing away the computation of `value`
+template<typename T>
+inline void do_not_optimize(T const& value)
+{
+#if defined(_MSC_VER)
+    auto const* volatile sink = &value;
+    static_cast<void>(sink);
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+/// Called once for each size, outside of the measurements: prepares the data, and returns the code to measure, which must process `size` items each time it is called.
+using Setup = std::function<std::function<void()>(size_t size)>;
+
+struct Benchmark {
+    std::string         name;
+    std::vector<size_t> sizes;
+    Setup               setup;
+};
+
+struct Options {
+    std::string               filter{};         // Only runs the benchmarks whose name contains it
+    std::chrono::milliseconds warm_up_time{50}; // Lets the caches, the branch predictors and the CPU frequency settle before measuring
+    std::chrono::milliseconds min_time{100};    // Of each repetition
+    size_t                    repetitions{5};
+};
+
+struct Result {
+    std::string         name;
+    size_t              size{};
+    size_t              iterations{};       // Per repetition
+    std::vector<double> ns_per_iteration{}; // One per repetition
+
+    auto median_ns() const -> double;
+    auto min_ns() const -> double;
+    auto mean_ns() const -> double;
+    auto stddev_ns() const -> double;
+    auto ns_per_item() const -> double { return median_ns() / static_cast<double>(size); }
+};
+
+/// Prints each result as soon as it is measured
+auto run(std::vector<Benchmark> const&, Options const&) -> std::vector<Result>;
+void save_json(std::vector<Result> const&, Options const&, std::filesystem::path const& path);
+
+} // namespace bench
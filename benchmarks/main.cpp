@@ -0,0 +1,253 @@
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "Curve.hpp"
+#include "ParticlePool.hpp"
+#include "bezier.hpp"
+#include "easing.hpp"
+#include "harness.hpp"
+#include "opengl-framework/opengl-framework.hpp"
+#include "rng.hpp"
+#include "segments.hpp"
+#include "simulation.hpp"
+
+// Headless: nothing here creates a window or touches OpenGL, so it runs on machines without a GPU.
+// Usage: Particles_benchmarks [--filter=<part of a name>] [--out=<results.json>] [--repetitions=<n>] [--min-time-ms=<n>]
+// Compare two result files with benchmarks/compare.py.
+
+static constexpr uint64_t seed = 42;
+
+static auto random_points(size_t count, uint64_t stream) -> std::vector<glm::vec2>
+{
+    rng::Generator         generator{seed, stream};
+    std::vector<glm::vec2> points(count);
+    for (glm::vec2& point : points)
+        point = {generator.uniform(-1.f, 1.f), generator.uniform(-1.f, 1.f)};
+    return points;
+}
+
+static auto random_floats(size_t count, float min, float max, uint64_t stream) -> std::vector<float>
+{
+    rng::Generator     generator{seed, stream};
+    std::vector<float> values(count);
+    generator.fill(values, min, max);
+    return values;
+}
+
+static auto uniform_parameters(size_t count) -> std::vector<float>
+{
+    std::vector<float> ts(count);
+    for (size_t i = 0; i < count; ++i)
+        ts[i] = static_cast<float>(i) / static_cast<float>(count - 1);
+    return ts;
+}
+
+static glm::vec2 const p0{-0.6f, -0.6f};
+static glm::vec2 const p1{-0.2f, 0.5f};
+static glm::vec2 const p2{0.3f, -0.4f};
+static glm::vec2 const p3{0.8f, 0.5f};
+
+/// Measures a function of the 4 control points and t, evaluated at `size` uniformly spaced parameters
+template<glm::vec2 (*Bezier)(glm::vec2, glm::vec2, glm::vec2, glm::vec2, float)>
+static auto bezier3_benchmark(std::string name) -> bench::Benchmark
+{
+    return {
+        .name  = std::move(name),
+        .sizes = {256, 65536},
+        .setup = [](size_t size) -> std::function<void()> {
+            return [ts = uniform_parameters(size)]() {
+                glm::vec2 sum{0.f};
+                for (float const t : ts)
+                    sum += Bezier(p0, p1, p2, p3, t);
+                bench::do_not_optimize(sum);
+            };
+        },
+    };
+}
+
+/// A square grid of `side` * `side` quads, without normals so that the loader has to compute them
+static auto write_grid_obj(size_t side) -> std::filesystem::path
+{
+    auto const path = std::filesystem::temp_directory_path() / ("particles_benchmark_grid_" + std::to_string(side) + ".obj");
+    auto       file = std::ofstream{path};
+    for (size_t y = 0; y <= side; ++y)
+    {
+        for (size_t x = 0; x <= side; ++x)
+            file << "v " << x << ' ' << y << " 0\n";
+    }
+    for (size_t y = 0; y < side; ++y)
+    {
+        for (size_t x = 0; x < side; ++x)
+        {
+            size_t const corner = y * (side + 1) + x + 1; // OBJ indices start at 1
+            file << "f " << corner << ' ' << corner + 1 << ' ' << corner + side + 2 << ' ' << corner + side + 1 << '\n';
+        }
+    }
+    return path;
+}
+
+static auto load_mesh_benchmark(std::string name, unsigned int threads_count) -> bench::Benchmark
+{
+    return {
+        .name  = std::move(name),
+        .sizes = {64 * 64, 512 * 512}, // Number of quads in the grid
+        .setup = [=](size_t size) -> std::function<void()> {
+            return [=, path = write_grid_obj(static_cast<size_t>(std::sqrt(static_cast<double>(size))))]() {
+                auto const data = gl::load_mesh_data(path, {.use_cache = false, .threads_count = threads_count, .optimize = false});
+                bench::do_not_optimize(data.vertices.data());
+            };
+        },
+    };
+}
+
+static auto simulation_benchmark(std::string name, bool mutual_attraction, std::vector<size_t> sizes) -> bench::Benchmark
+{
+    return {
+        .name  = std::move(name),
+        .sizes = std::move(sizes),
+        .setup = [=](size_t size) -> std::function<void()> {
+            auto initial_particles = std::make_shared<ParticlePool>(size);
+            initial_particles->spawn(size);
+            rng::Generator generator{seed};
+            generator.fill(initial_particles->x(), -1.f, 1.f);
+            generator.fill(initial_particles->y(), -1.f, 1.f);
+            generator.fill(initial_particles->vx(), -0.1f, 0.1f);
+            generator.fill(initial_particles->vy(), -0.1f, 0.1f);
+            generator.fill(initial_particles->mass(), 1.f, 2.f);
+            generator.fill(initial_particles->lifespan(), 5.f, 15.f);
+            return [=, particles = std::make_shared<ParticlePool>(*initial_particles), curve = Curve{{.kind = CurveKind::Bezier, .control_points = {p0, p1, p2, p3}}}, scratch = std::make_shared<simulation::Scratch>()]() {
+                // Every iteration steps the same particles, otherwise the measure would depend on how many iterations ran before (e.g. the particles clump with the mutual attraction).
+                // Copying them costs a few memcpy()s, negligible compared to the step itself.
+                *particles = *initial_particles;
+                simulation::step(*particles, curve, {.mutual_attraction = mutual_attraction}, 1.f / 60.f, *scratch);
+                bench::do_not_optimize(particles->x().data());
+            };
+        },
+    };
+}
+
+static auto all_benchmarks() -> std::vector<bench::Benchmark>
+{
+    return {
+        {
+            .name  = "intersect_segments",
+            .sizes = {1024, 65536},
+            .setup = [](size_t size) -> std::function<void()> {
+                return [a = random_points(size, 0), b = random_points(size, 1), c = random_points(size, 2), d = random_points(size, 3)]() {
+                    size_t hits = 0;
+                    for (size_t i = 0; i < a.size(); ++i)
+                    {
+                        if (intersect_segments(a[i], b[i], c[i], d[i]))
+                            ++hits;
+                    }
+                    bench::do_not_optimize(hits);
+                };
+            },
+        },
+        bezier3_benchmark<&bezier3>("bezier3"),
+        bezier3_benchmark<&bezier3_casteljau>("bezier3_casteljau"),
+        bezier3_benchmark<&bezier3_bernstein>("bezier3_bernstein"),
+        {
+            .name  = "bezier_evaluate_uniform",
+            .sizes = {256, 65536},
+            .setup = [](size_t size) -> std::function<void()> {
+                return [control_points = std::vector<glm::vec2>{p0, p1, p2, p3}, out = std::vector<glm::vec2>(size)]() mutable {
+                    bezier_evaluate_uniform(control_points, out);
+                    bench::do_not_optimize(out.data());
+                };
+            },
+        },
+        {
+            .name  = "Curve::evaluate (batched)",
+            .sizes = {256, 65536},
+            .setup = [](size_t size) -> std::function<void()> {
+                return [curve = Curve{{.kind = CurveKind::Bezier, .control_points = {p0, p1, p2, p3}}}, ts = random_floats(size, 0.f, 1.f, 0), xs = std::vector<float>(size), ys = std::vector<float>(size)]() mutable {
+                    curve.evaluate(ts, xs, ys);
+                    bench::do_not_optimize(xs.data());
+                };
+            },
+        },
+        {
+            .name  = "find_closest_t_on_bezier3",
+            .sizes = {1024, 16384},
+            .setup = [](size_t size) -> std::function<void()> {
+                return [points = random_points(size, 0)]() {
+                    float sum = 0.f;
+                    for (glm::vec2 const point : points)
+                        sum += find_closest_t_on_bezier3(p0, p1, p2, p3, point);
+                    bench::do_not_optimize(sum);
+                };
+            },
+        },
+        {
+            .name  = "easing::in_out<3>",
+            .sizes = {1024, 65536},
+            .setup = [](size_t size) -> std::function<void()> {
+                return [in = random_floats(size, 0.f, 1.f, 0), out = std::vector<float>(size)]() mutable {
+                    easing::apply<easing::in_out<3>>(in, out);
+                    bench::do_not_optimize(out.data());
+                };
+            },
+        },
+        simulation_benchmark("simulation::step", false, {1024, 16384, 65536}),
+        simulation_benchmark("simulation::step (mutual attraction)", true, {1024, 16384}),
+        load_mesh_benchmark("load_mesh_data (classic)", 1),
+        load_mesh_benchmark("load_mesh_data (multithreaded)", 0),
+    };
+}
+
+/// Returns false if `text` is not a number of type T, with nothing after it
+template<typename T>
+static auto parse_number(std::string_view text, T& number) -> bool
+{
+    auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), number); // NOLINT(*pointer-arithmetic)
+    return error == std::errc{} && end == text.data() + text.size();                         // NOLINT(*pointer-arithmetic)
+}
+
+static constexpr std::string_view usage = " [--filter=<part of a name>] [--out=<results.json>] [--repetitions=<n>] [--min-time-ms=<n>]\n";
+
+int main(int argc, char** argv)
+{
+    bench::Options        options{};
+    std::filesystem::path output_path = "benchmark_results.json";
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view const argument{argv[i]}; // NOLINT(*pointer-arithmetic)
+        auto const             value    = argument.substr(std::min(argument.find('=') + 1, argument.size()));
+        bool                   is_valid = true;
+        if (argument.starts_with("--filter="))
+            options.filter = value;
+        else if (argument.starts_with("--out="))
+            output_path = value;
+        else if (argument.starts_with("--repetitions="))
+            is_valid = parse_number(value, options.repetitions);
+        else if (argument.starts_with("--min-time-ms="))
+        {
+            uint32_t milliseconds{};
+            is_valid         = parse_number(value, milliseconds);
+            options.min_time = std::chrono::milliseconds{milliseconds};
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << argument << "\nUsage: " << argv[0] << usage;
+            return 1;
+        }
+        if (!is_valid)
+        {
+            std::cerr << "Invalid value: " << argument << "\nUsage: " << argv[0] << usage;
+            return 1;
+        }
+    }
+
+    auto const results = bench::run(all_benchmarks(), options);
+    bench::save_json(results, options, output_path);
+    std::cout << "Results saved to " << std::filesystem::absolute(output_path).string() << '\n';
+}
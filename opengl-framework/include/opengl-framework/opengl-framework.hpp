@@ -2,11 +2,17 @@
 #include <string_view>
 #include "../../src/Camera.hpp"
 #include "../../src/EventsCallbacks.hpp"
+#include "../../src/GpuBufferArena.hpp"
 #include "../../src/Mesh.hpp"
+#include "../../src/MeshPool.hpp"
+#include "../../src/Profiler.hpp"
+#include "../../src/RenderStats.hpp"
 #include "../../src/RenderTarget.hpp"
 #include "../../src/Shader.hpp"
 #include "../../src/Texture.hpp"
+#include "../../src/load_mesh.hpp"
 #include "../../src/make_absolute_path.hpp"
+#include "../../src/optimize_mesh.hpp"
 #include "glad/gl.h"
 #include "glm/glm.hpp"
 #include "tiny_obj_loader.h"
@@ -15,6 +21,9 @@ namespace gl {
 
 /// Must be the very first line of your program.
 void init(std::string_view window_title);
+/// Like init(), but never shows the window: for tests and tools that need OpenGL on machines without a screen.
+/// On Linux it doesn't even need a display server, the context is created through EGL (e.g. Mesa's llvmpipe with LIBGL_ALWAYS_SOFTWARE=1).
+void init_headless();
 
 void maximize_window();
 
@@ -36,6 +45,9 @@ auto delta_time_in_seconds() -> float;
 
 auto mouse_position() -> glm::vec2;
 
+/// Whether the context supports OpenGL 4.3 features like compute shaders and shader storage buffers. Always false on MacOS.
+auto supports_compute_shaders() -> bool;
+
 void bind_default_shader();
 auto sphere_vertices();
 
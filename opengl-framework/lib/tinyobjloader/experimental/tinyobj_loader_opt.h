@@ -88,7 +88,7 @@ namespace tinyobj_opt {
 template <typename T, size_t stack_capacity>
 class StackAllocator : public std::allocator<T> {
  public:
-  typedef typename std::allocator<T>::pointer pointer;
+  typedef T *pointer;  // std::allocator<T>::pointer was removed in C++20
   typedef typename std::allocator<T>::size_type size_type;
 
   // Backing store for the allocator. The container owner is responsible for
@@ -150,13 +150,13 @@ class StackAllocator : public std::allocator<T> {
   // Actually do the allocation. Use the stack buffer if nobody has used it yet
   // and the size requested fits. Otherwise, fall through to the standard
   // allocator.
-  pointer allocate(size_type n, void *hint = 0) {
+  pointer allocate(size_type n, void * /*hint*/ = 0) {
     if (source_ != NULL && !source_->used_stack_buffer_ &&
         n <= stack_capacity) {
       source_->used_stack_buffer_ = true;
       return source_->stack_buffer();
     } else {
-      return std::allocator<T>::allocate(n, hint);
+      return std::allocator<T>::allocate(n);  // The hint overload was removed in C++20
     }
   }
 
@@ -0,0 +1,192 @@
+#include "GpuBufferArena.hpp"
+#include <algorithm>
+#include <cassert>
+#include <format>
+#include <utility>
+#include "RenderStats.hpp"
+#include "handle_error.hpp"
+
+namespace gl {
+
+static auto create_buffer(size_t size_in_bytes) -> GLuint
+{
+    GLuint buffer{};
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size_in_bytes), nullptr, GL_DYNAMIC_DRAW);
+    return buffer;
+}
+
+GpuBufferArena::GpuBufferArena(GpuBufferArena_Descriptor const& desc)
+    : _unit_size{desc.unit_size}
+    , _can_grow{desc.can_grow}
+    , _allocator{static_cast<uint32_t>((desc.initial_capacity + desc.unit_size - 1) / desc.unit_size)}
+{
+    assert(_unit_size % 4 == 0 && "The unit size of a GpuBufferArena must be a multiple of 4 bytes");
+    _buffer = create_buffer(_allocator.capacity() * _unit_size);
+}
+
+GpuBufferArena::~GpuBufferArena()
+{
+    glDeleteBuffers(1, &_buffer);
+}
+
+GpuBufferArena::GpuBufferArena(GpuBufferArena&& o) noexcept
+    : _unit_size{o._unit_size}
+    , _can_grow{o._can_grow}
+    , _buffer{std::exchange(o._buffer, 0)}
+    , _allocator{std::move(o._allocator)}
+    , _generation{o._generation}
+    , _allocations{std::move(o._allocations)}
+    , _is_alive{std::move(o._is_alive)}
+    , _free_ids{std::move(o._free_ids)}
+{
+}
+
+auto GpuBufferArena::operator=(GpuBufferArena&& o) noexcept -> GpuBufferArena&
+{
+    if (this != &o)
+    {
+        glDeleteBuffers(1, &_buffer);
+        _unit_size   = o._unit_size;
+        _can_grow    = o._can_grow;
+        _buffer      = std::exchange(o._buffer, 0);
+        _allocator   = std::move(o._allocator);
+        _generation  = o._generation + 1; // Whoever was watching this arena must not confuse it with the new one
+        _allocations = std::move(o._allocations);
+        _is_alive    = std::move(o._is_alive);
+        _free_ids    = std::move(o._free_ids);
+    }
+    return *this;
+}
+
+auto GpuBufferArena::allocation(ArenaAllocation handle) const -> OffsetAllocation const&
+{
+    assert(handle.id < _allocations.size() && _is_alive[handle.id] && "This allocation doesn't belong to this arena, or has already been freed");
+    return _allocations[handle.id];
+}
+
+auto GpuBufferArena::allocate(size_t size_in_bytes) -> ArenaAllocation
+{
+    auto const units = static_cast<uint32_t>(std::max<size_t>((size_in_bytes + _unit_size - 1) / _unit_size, 1));
+    auto       range = _allocator.allocate(units);
+    if (!range)
+    {
+        grow(units);
+        range = _allocator.allocate(units);
+        assert(range.has_value());
+    }
+
+    ArenaAllocation handle{};
+    if (!_free_ids.empty())
+    {
+        handle.id = _free_ids.back();
+        _free_ids.pop_back();
+    }
+    else
+    {
+        handle.id = static_cast<uint32_t>(_allocations.size());
+        _allocations.emplace_back();
+        _is_alive.push_back(false);
+    }
+    _allocations[handle.id] = *range;
+    _is_alive[handle.id]    = true;
+    return handle;
+}
+
+void GpuBufferArena::free(ArenaAllocation handle)
+{
+    _allocator.free(allocation(handle));
+    _is_alive[handle.id] = false;
+    _free_ids.push_back(handle.id);
+}
+
+void GpuBufferArena::upload(ArenaAllocation handle, std::span<std::byte const> data, size_t offset_in_bytes)
+{
+    if (data.empty())
+        return;
+    assert(offset_in_bytes + data.size() <= size_in_bytes(handle) && "Trying to upload more data than the allocation can hold");
+    // GL_COPY_WRITE_BUFFER is not used for drawing, so binding to it doesn't mess with the vertex array that is currently bound
+    render_stats::count_buffer_upload(data.size());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(this->offset_in_bytes(handle) + offset_in_bytes), static_cast<GLsizeiptr>(data.size()), data.data());
+}
+
+auto GpuBufferArena::offset_in_bytes(ArenaAllocation handle) const -> size_t
+{
+    return allocation(handle).offset * _unit_size;
+}
+
+auto GpuBufferArena::size_in_bytes(ArenaAllocation handle) const -> size_t
+{
+    return allocation(handle).size * _unit_size;
+}
+
+auto GpuBufferArena::stats() const -> GpuBufferArena_Stats
+{
+    auto const stats = _allocator.stats();
+    return GpuBufferArena_Stats{
+        .capacity           = stats.capacity * _unit_size,
+        .used               = stats.used * _unit_size,
+        .allocations_count  = stats.allocations_count,
+        .free_blocks_count  = stats.free_blocks_count,
+        .largest_free_block = stats.largest_free_block * _unit_size,
+    };
+}
+
+void GpuBufferArena::grow(uint32_t required_units)
+{
+    if (!_can_grow)
+    {
+        auto const stats = this->stats();
+        handle_error(std::format("GpuBufferArena is full: could not allocate {} bytes ({} bytes used out of {}, largest free block is {} bytes). Increase its initial_capacity, allow it to grow, or defragment it.", required_units * _unit_size, stats.used, stats.capacity, stats.largest_free_block));
+    }
+
+    uint32_t const old_capacity = _allocator.capacity();
+    uint32_t const new_capacity = std::max(2 * old_capacity, old_capacity + required_units);
+    GLuint const   new_buffer   = create_buffer(new_capacity * _unit_size);
+    glBindBuffer(GL_COPY_READ_BUFFER, _buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(old_capacity * _unit_size));
+    glDeleteBuffers(1, &_buffer);
+    _buffer = new_buffer;
+    _allocator.grow(new_capacity);
+    ++_generation;
+}
+
+void GpuBufferArena::defragment(std::function<void(ArenaAllocation, size_t old_offset_in_bytes, size_t new_offset_in_bytes)> const& on_moved)
+{
+    std::vector<uint32_t> ids{};
+    for (uint32_t id = 0; id < _allocations.size(); ++id)
+    {
+        if (_is_alive[id])
+            ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) {
+        return _allocations[a].offset < _allocations[b].offset;
+    });
+
+    // Copying into a new buffer, because copying between overlapping ranges of the same buffer is not allowed
+    GLuint const new_buffer = create_buffer(_allocator.capacity() * _unit_size);
+    glBindBuffer(GL_COPY_READ_BUFFER, _buffer);
+    std::vector<OffsetAllocation> const old_allocations = _allocations;
+    _allocator.reset();
+    for (uint32_t const id : ids)
+    {
+        OffsetAllocation const& old_range = old_allocations[id];
+        _allocations[id]                  = *_allocator.allocate(old_range.size); // A fresh allocator hands out offsets one after the other
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(old_range.offset * _unit_size), static_cast<GLintptr>(_allocations[id].offset * _unit_size), static_cast<GLsizeiptr>(old_range.size * _unit_size));
+    }
+    glDeleteBuffers(1, &_buffer);
+    _buffer = new_buffer;
+    ++_generation;
+
+    if (!on_moved)
+        return;
+    for (uint32_t const id : ids)
+    {
+        if (old_allocations[id].offset != _allocations[id].offset)
+            on_moved(ArenaAllocation{id}, old_allocations[id].offset * _unit_size, _allocations[id].offset * _unit_size);
+    }
+}
+
+} // namespace gl
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include "OffsetAllocator.hpp"
+#include "glad/gl.h"
+
+namespace gl {
+
+struct GpuBufferArena_Descriptor {
+    /// All offsets and sizes are multiples of it, in bytes. Must be a multiple of 4.
+    /// Using the size of a vertex allows drawing with a base vertex instead of a byte offset (see MeshPool).
+    size_t unit_size{4};
+    /// In bytes
+    size_t initial_capacity{1024 * 1024};
+    /// When full, doubles the size of the buffer (which copies all of it) instead of failing.
+    bool can_grow{true};
+};
+
+struct GpuBufferArena_Stats {
+    size_t capacity{};           // In bytes
+    size_t used{};               // In bytes
+    size_t allocations_count{};  //
+    size_t free_blocks_count{};  //
+    size_t largest_free_block{}; // In bytes
+
+    /// 0 when all the free space is in one block, close to 1 when it is scattered into many small blocks
+    auto fragmentation() const -> float
+    {
+        size_t const free_space = capacity - used;
+        return free_space == 0 ? 0.f : 1.f - static_cast<float>(largest_free_block) / static_cast<float>(free_space);
+    }
+};
+
+/// A range of a GpuBufferArena. It stays valid when the arena grows or gets defragmented, but its offset might change: always ask the arena for it.
+struct ArenaAllocation {
+    uint32_t id{0xFFFFFFFF};
+
+    auto is_valid() const -> bool { return id != 0xFFFFFFFF; }
+};
+
+/// A big GPU buffer shared by many small pieces of data (e.g. the vertices of many meshes), which is way cheaper than creating a buffer for each of them.
+class GpuBufferArena {
+public:
+    explicit GpuBufferArena(GpuBufferArena_Descriptor const& = {});
+    ~GpuBufferArena();
+    GpuBufferArena(GpuBufferArena const&)                    = delete; // You cannot copy a GpuBufferArena.
+    auto operator=(GpuBufferArena const&) -> GpuBufferArena& = delete; // But you can move it, using std::move(my_arena)
+    GpuBufferArena(GpuBufferArena&&) noexcept;
+    auto operator=(GpuBufferArena&&) noexcept -> GpuBufferArena&;
+
+    /// The size is rounded up to a multiple of the unit size
+    auto allocate(size_t size_in_bytes) -> ArenaAllocation;
+    void free(ArenaAllocation);
+    /// Writes `data` into the allocation, starting `offset_in_bytes` into it
+    void upload(ArenaAllocation, std::span<std::byte const> data, size_t offset_in_bytes = 0);
+
+    auto offset_in_bytes(ArenaAllocation) const -> size_t;
+    auto size_in_bytes(ArenaAllocation) const -> size_t;
+    auto unit_size() const -> size_t { return _unit_size; }
+    auto buffer() const -> GLuint { return _buffer; }
+    /// Changes each time the buffer or the offsets change (when growing or defragmenting). Anything that stored them (e.g. in a vertex array) must fetch them again.
+    auto generation() const -> uint64_t { return _generation; }
+    auto stats() const -> GpuBufferArena_Stats;
+
+    /// Moves all the allocations to the beginning of the buffer, without holes between them, so that all the free space is in one block.
+    /// `on_moved` is called for each allocation whose offset changed, after the move.
+    void defragment(std::function<void(ArenaAllocation, size_t old_offset_in_bytes, size_t new_offset_in_bytes)> const& on_moved = {});
+
+private:
+    auto allocation(ArenaAllocation) const -> OffsetAllocation const&;
+    void grow(uint32_t required_units);
+
+private:
+    size_t          _unit_size{};
+    bool            _can_grow{};
+    GLuint          _buffer{};
+    OffsetAllocator _allocator;
+    uint64_t        _generation{0};
+
+    std::vector<OffsetAllocation> _allocations{}; // Indexed by ArenaAllocation::id
+    std::vector<bool>             _is_alive{};    //
+    std::vector<uint32_t>         _free_ids{};
+};
+
+} // namespace gl
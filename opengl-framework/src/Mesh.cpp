@@ -1,7 +1,12 @@
 #include "Mesh.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <numeric>
+#include <utility>
 #include <opengl-framework/opengl-framework.hpp>
+#include "RenderStats.hpp"
+#include "handle_error.hpp"
 
 namespace gl {
 
@@ -17,51 +22,146 @@ static auto type(AnyVertexAttribute const& attr)
 {
     return std::visit([](auto&& attr) { return attr.type(); }, attr);
 }
+static auto normalized(AnyVertexAttribute const& attr)
+{
+    return std::visit([](auto&& attr) { return attr.normalized(); }, attr);
+}
+static auto component_size_in_bytes(GLenum type) -> int
+{
+    switch (type)
+    {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+        return 2;
+    default:
+        return 4;
+    }
+}
 static auto size_in_bytes(AnyVertexAttribute const& attr)
 {
-    return size(attr) * 4;
+    return size(attr) * component_size_in_bytes(type(attr));
+}
+
+auto internal::vertex_size_in_bytes(std::vector<AnyVertexAttribute> const& layout) -> int
+{
+    return std::accumulate(layout.begin(), layout.end(), 0, [](int acc, AnyVertexAttribute const& attr) {
+        return acc + size_in_bytes(attr);
+    });
+}
+
+void internal::set_vertex_attributes(std::vector<AnyVertexAttribute> const& layout, GLuint instance_divisor, size_t offset, size_t stride)
+{
+    auto const stride_in_bytes = static_cast<GLsizei>(stride != 0 ? stride : static_cast<size_t>(vertex_size_in_bytes(layout)));
+    uint64_t   pointer{offset};
+    for (auto const& attribute : layout)
+    {
+        glEnableVertexAttribArray(index(attribute));
+        glVertexAttribPointer(index(attribute), size(attribute), type(attribute), normalized(attribute), stride_in_bytes, reinterpret_cast<void*>(pointer)); // NOLINT(*reinterpret-cast, performance-no-int-to-ptr)
+        glVertexAttribDivisor(index(attribute), instance_divisor);
+        pointer += size_in_bytes(attribute);
+    }
+}
+
+/// The largest 16-bit value is kept for primitive_restart_index
+static auto fits_in_16_bits(std::span<uint32_t const> indices) -> bool
+{
+    return std::all_of(indices.begin(), indices.end(), [](uint32_t index) {
+        return index < 0xFFFF || index == primitive_restart_index;
+    });
+}
+
+static auto narrow_to_16_bits(std::span<uint32_t const> indices) -> std::vector<uint16_t>
+{
+    std::vector<uint16_t> narrowed(indices.size());
+    std::transform(indices.begin(), indices.end(), narrowed.begin(), [](uint32_t index) {
+        return index == primitive_restart_index ? uint16_t{0xFFFF} : static_cast<uint16_t>(index);
+    });
+    return narrowed;
+}
+
+static auto widen_to_32_bits(std::span<uint16_t const> indices) -> std::vector<uint32_t>
+{
+    std::vector<uint32_t> widened(indices.size());
+    std::transform(indices.begin(), indices.end(), widened.begin(), [](uint16_t index) {
+        return index == 0xFFFF ? primitive_restart_index : uint32_t{index};
+    });
+    return widened;
+}
+
+[[maybe_unused]] static auto vertices_per_primitive(PrimitiveTopology topology) -> size_t
+{
+    switch (topology)
+    {
+    case PrimitiveTopology::Triangles:
+        return 3;
+    case PrimitiveTopology::Lines:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+static auto is_strip(PrimitiveTopology topology) -> bool
+{
+    return topology == PrimitiveTopology::TriangleStrip || topology == PrimitiveTopology::LineStrip;
 }
 
 Mesh::Mesh(Mesh_Descriptor desc)
+    : _topology{desc.topology}
+    , _arena{desc.arena}
 {
     assert(!desc.vertex_buffers.empty() && "You must provide at least one vertex buffer to construct a mesh.");
 
     if (!desc.index_buffer.empty())
     {
-        assert(desc.index_buffer.size() % 3 == 0 && "You must provide 3 indices for each triangle");
-        _triangles_count = desc.index_buffer.size() / 3;
-    }
-
-    { // Vertex Array
-        glGenVertexArrays(1, &_vertex_array);
-        glBindVertexArray(_vertex_array);
+        assert(desc.index_buffer.size() % vertices_per_primitive(_topology) == 0 && "The number of indices doesn't match the topology: you must provide 3 indices for each triangle, and 2 for each line");
+        _elements_count = desc.index_buffer.size();
     }
 
     { // Vertex Buffers
-        _vertex_buffers.resize(desc.vertex_buffers.size());
-        glGenBuffers(static_cast<int>(_vertex_buffers.size()), _vertex_buffers.data());
-        for (size_t i = 0; i < _vertex_buffers.size(); ++i)
+        if (_arena == nullptr)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffers[i]);
-            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(desc.vertex_buffers[i].data.size() * sizeof(GLfloat)), desc.vertex_buffers[i].data.data(), GL_STATIC_DRAW);
-
-            int const stride = std::accumulate(desc.vertex_buffers[i].layout.begin(), desc.vertex_buffers[i].layout.end(), 0, [](int acc, AnyVertexAttribute const& attr) {
-                return acc + size_in_bytes(attr);
-            });
-            if (desc.index_buffer.empty())
+            _vertex_buffers.resize(desc.vertex_buffers.size());
+            glGenBuffers(static_cast<int>(_vertex_buffers.size()), _vertex_buffers.data());
+        }
+        bool is_first_per_vertex_buffer = true;
+        for (size_t i = 0; i < desc.vertex_buffers.size(); ++i)
+        {
+            auto const data = desc.vertex_buffers[i].data.bytes();
+            if (_arena != nullptr)
             {
-                auto const triangles_count = desc.vertex_buffers[i].data.size() / (stride / sizeof(float)) / 3;
-                if (i == 0)
-                    _triangles_count = triangles_count;
-                else
-                    assert(_triangles_count == triangles_count && "Some vertex buffers contain more vertices than others! Make sure that their data is correct, and that the layout matches the data.");
+                _arena_vertex_buffers.push_back(_arena->allocate(data.size()));
+                _arena->upload(_arena_vertex_buffers.back(), data);
             }
-            uint64_t pointer{0};
-            for (auto const& attribute : desc.vertex_buffers[i].layout)
+            else
+            {
+                render_stats::count_buffer_upload(data.size());
+                glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffers[i]);
+                glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(data.size()), data.data(), desc.vertex_buffers[i].instance_divisor == 0 ? GL_STATIC_DRAW : GL_STREAM_DRAW);
+            }
+
+            auto const attributes_size = static_cast<size_t>(internal::vertex_size_in_bytes(desc.vertex_buffers[i].layout));
+            auto const stride          = desc.vertex_buffers[i].stride != 0 ? desc.vertex_buffers[i].stride : attributes_size;
+            assert(desc.vertex_buffers[i].offset + attributes_size <= stride && "The attributes of the layout don't fit in the stride");
+            assert(data.size() % stride == 0 && "The size of the data is not a multiple of the size of a vertex. Make sure that the layout (and stride) match the data.");
+            _layouts.push_back(desc.vertex_buffers[i].layout);
+            _instance_divisors.push_back(desc.vertex_buffers[i].instance_divisor);
+            _strides.push_back(stride);
+            _attribute_offsets.push_back(desc.vertex_buffers[i].offset);
+            _vertex_buffers_sizes.push_back(data.size());
+            if (desc.index_buffer.empty() && desc.vertex_buffers[i].instance_divisor == 0)
             {
-                glEnableVertexAttribArray(index(attribute));
-                glVertexAttribPointer(index(attribute), size(attribute), type(attribute), GL_FALSE, stride, reinterpret_cast<void*>(pointer)); // NOLINT(*reinterpret-cast, performance-no-int-to-ptr)
-                pointer += size_in_bytes(attribute);
+                auto const vertices_count = data.size() / stride;
+                if (is_first_per_vertex_buffer)
+                    _elements_count = vertices_count;
+                else
+                    assert(_elements_count == vertices_count && "Some vertex buffers contain more vertices than others! Make sure that their data is correct, and that the layout matches the data.");
+                assert(vertices_count % vertices_per_primitive(_topology) == 0 && "The number of vertices doesn't match the topology: you must provide 3 vertices for each triangle, and 2 for each line");
+                is_first_per_vertex_buffer = false;
             }
         }
     }
@@ -69,60 +169,347 @@ Mesh::Mesh(Mesh_Descriptor desc)
     { // Index Buffer
         if (!desc.index_buffer.empty())
         {
-            glGenBuffers(1, &_maybe_index_buffer);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _maybe_index_buffer);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(desc.index_buffer.size() * sizeof(uint32_t)), desc.index_buffer.data(), GL_STATIC_DRAW);
+            _has_index_buffer = true;
+            std::vector<uint16_t>      narrowed_indices{};
+            std::span<std::byte const> indices{};
+            if (desc.index_buffer.indices_32_bits().empty())
+            {
+                indices     = std::as_bytes(desc.index_buffer.indices_16_bits());
+                _index_type = GL_UNSIGNED_SHORT;
+            }
+            else if (fits_in_16_bits(desc.index_buffer.indices_32_bits()))
+            {
+                narrowed_indices = narrow_to_16_bits(desc.index_buffer.indices_32_bits());
+                indices          = std::as_bytes(std::span{narrowed_indices});
+                _index_type      = GL_UNSIGNED_SHORT;
+            }
+            else
+            {
+                indices     = std::as_bytes(desc.index_buffer.indices_32_bits());
+                _index_type = GL_UNSIGNED_INT;
+            }
+
+            if (_arena != nullptr)
+            {
+                _arena_index_buffer = _arena->allocate(indices.size());
+                _arena->upload(_arena_index_buffer, indices);
+            }
+            else
+            {
+                glGenBuffers(1, &_maybe_index_buffer);
+                render_stats::count_buffer_upload(indices.size());
+                glBindBuffer(GL_COPY_WRITE_BUFFER, _maybe_index_buffer);
+                glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(indices.size()), indices.data(), GL_STATIC_DRAW);
+            }
         }
     }
+
+    _pending_vertices_updates.resize(desc.vertex_buffers.size());
+
+    { // Vertex Array
+        glGenVertexArrays(1, &_vertex_array);
+        bind_buffers();
+    }
 }
 
-void Mesh::draw() const
+void Mesh::bind_buffers() const
 {
     glBindVertexArray(_vertex_array);
-    if (_maybe_index_buffer != 0)
-        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(3 * _triangles_count), GL_UNSIGNED_INT, reinterpret_cast<void*>(0)); // NOLINT(*reinterpret-cast)
+    for (size_t i = 0; i < _layouts.size(); ++i)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _arena != nullptr ? _arena->buffer() : _vertex_buffers[i]);
+        size_t const buffer_offset = _arena != nullptr ? _arena->offset_in_bytes(_arena_vertex_buffers[i]) : 0;
+        internal::set_vertex_attributes(_layouts[i], _instance_divisors[i], buffer_offset + _attribute_offsets[i], _strides[i]);
+    }
+    if (_has_index_buffer)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _arena != nullptr ? _arena->buffer() : _maybe_index_buffer);
+        _index_offset = _arena != nullptr ? _arena->offset_in_bytes(_arena_index_buffer) : 0;
+    }
+    if (_arena != nullptr)
+        _arena_generation = _arena->generation();
+}
+
+void Mesh::draw() const
+{
+    draw_instanced(1);
+}
+
+void Mesh::draw_instanced(size_t instances_count) const
+{
+    if (_has_pending_updates)
+        flush_updates();
+    if (_arena != nullptr && _arena->generation() != _arena_generation)
+        bind_buffers(); // Our data has moved in the arena
     else
-        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(3 * _triangles_count));
+        glBindVertexArray(_vertex_array);
+
+    render_stats::count(render_stats::Counter::DrawCalls);
+    auto const mode  = static_cast<GLenum>(_topology);
+    auto const count = static_cast<GLsizei>(_elements_count);
+    if (_has_index_buffer)
+    {
+        bool const use_primitive_restart = is_strip(_topology);
+        if (use_primitive_restart)
+        {
+            glEnable(GL_PRIMITIVE_RESTART);
+            glPrimitiveRestartIndex(_index_type == GL_UNSIGNED_SHORT ? 0xFFFF : primitive_restart_index);
+        }
+        auto* const offset = reinterpret_cast<void*>(_index_offset); // NOLINT(*reinterpret-cast, performance-no-int-to-ptr)
+        if (instances_count == 1)
+            glDrawElements(mode, count, _index_type, offset);
+        else
+            glDrawElementsInstanced(mode, count, _index_type, offset, static_cast<GLsizei>(instances_count));
+        if (use_primitive_restart)
+            glDisable(GL_PRIMITIVE_RESTART);
+    }
+    else
+    {
+        if (instances_count == 1)
+            glDrawArrays(mode, 0, count);
+        else
+            glDrawArraysInstanced(mode, 0, count, static_cast<GLsizei>(instances_count));
+    }
 }
 
-Mesh::~Mesh()
+void Mesh::set_vertex_buffer_data(size_t buffer_index, VertexData data)
+{
+    auto const bytes = data.bytes();
+    if (_arena != nullptr)
+    {
+        ArenaAllocation& allocation = _arena_vertex_buffers.at(buffer_index);
+        if (_arena->size_in_bytes(allocation) < bytes.size())
+        {
+            _arena->free(allocation);
+            allocation = _arena->allocate(bytes.size());
+        }
+        _arena->upload(allocation, bytes);
+        bind_buffers();
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffers.at(buffer_index));
+        render_stats::count_buffer_upload(bytes.size());
+        // Reallocating the whole buffer, instead of overwriting it with glBufferSubData(), lets the driver give us new memory instead of waiting for the GPU to be done with the previous data.
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes.size()), bytes.data(), GL_STREAM_DRAW);
+    }
+    _vertex_buffers_sizes[buffer_index] = bytes.size();
+    _pending_vertices_updates[buffer_index].clear(); // They have been overwritten
+    if (!_has_index_buffer && _instance_divisors[buffer_index] == 0)
+        _elements_count = bytes.size() / _strides[buffer_index];
+}
+
+void Mesh::PendingUpdates::add(size_t offset_in_buffer, std::span<std::byte const> bytes)
+{
+    ranges.push_back({.offset_in_buffer = offset_in_buffer, .offset_in_data = data.size(), .size = bytes.size()});
+    data.insert(data.end(), bytes.begin(), bytes.end());
+}
+
+void Mesh::PendingUpdates::clear()
+{
+    // Keeps the capacity, so that updating the mesh each frame doesn't allocate
+    ranges.clear();
+    data.clear();
+}
+
+void Mesh::update_vertices(size_t buffer_index, size_t first_vertex, VertexData data)
+{
+    auto const   bytes  = data.bytes();
+    size_t const stride = _strides.at(buffer_index);
+    assert(bytes.size() % stride == 0 && "The size of the data is not a multiple of the size of a vertex. Make sure that it is laid out like the vertex buffer.");
+    assert((first_vertex * stride) + bytes.size() <= _vertex_buffers_sizes[buffer_index] && "Trying to update vertices past the end of the buffer. Use set_vertex_buffer_data() to change its size.");
+    if (bytes.empty())
+        return;
+    _pending_vertices_updates[buffer_index].add(first_vertex * stride, bytes);
+    _has_pending_updates = true;
+}
+
+void Mesh::update_indices(size_t first_index, IndexData data)
+{
+    assert(_has_index_buffer && "This mesh has no index buffer");
+    assert(first_index + data.size() <= _elements_count && "Trying to update indices past the end of the buffer");
+    if (data.empty())
+        return;
+
+    size_t const offset_in_buffer = first_index * (_index_type == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+    if (_index_type == GL_UNSIGNED_SHORT)
+    {
+        if (data.indices_32_bits().empty())
+        {
+            _pending_indices_updates.add(offset_in_buffer, std::as_bytes(data.indices_16_bits()));
+        }
+        else
+        {
+            // Checked in release builds too: narrowing would silently wrap the indices around, and the mesh would reference the wrong vertices
+            if (!fits_in_16_bits(data.indices_32_bits()))
+                handle_error("This mesh stores its indices on 16 bits, because the ones it was created with were all small enough. They cannot reference more than 65535 vertices.");
+            auto const narrowed_indices = narrow_to_16_bits(data.indices_32_bits());
+            _pending_indices_updates.add(offset_in_buffer, std::as_bytes(std::span{narrowed_indices}));
+        }
+    }
+    else
+    {
+        if (!data.indices_32_bits().empty())
+        {
+            _pending_indices_updates.add(offset_in_buffer, std::as_bytes(data.indices_32_bits()));
+        }
+        else
+        {
+            auto const widened_indices = widen_to_32_bits(data.indices_16_bits());
+            _pending_indices_updates.add(offset_in_buffer, std::as_bytes(std::span{widened_indices}));
+        }
+    }
+    _has_pending_updates = true;
+}
+
+void Mesh::flush_updates() const
+{
+    for (size_t i = 0; i < _pending_vertices_updates.size(); ++i)
+    {
+        upload(_pending_vertices_updates[i], _arena != nullptr ? 0 : _vertex_buffers[i], _arena != nullptr ? _arena_vertex_buffers[i] : ArenaAllocation{});
+        _pending_vertices_updates[i].clear();
+    }
+    upload(_pending_indices_updates, _maybe_index_buffer, _arena_index_buffer);
+    _pending_indices_updates.clear();
+    _has_pending_updates = false;
+}
+
+/// Merges the ranges that overlap or touch each other, so that we do one glBufferSubData() per contiguous range instead of one per update
+void Mesh::upload(PendingUpdates const& updates, GLuint buffer, ArenaAllocation allocation) const
+{
+    if (updates.ranges.empty())
+        return;
+
+    auto const upload_bytes = [&](size_t offset_in_buffer, std::span<std::byte const> bytes) {
+        if (_arena != nullptr)
+        {
+            _arena->upload(allocation, bytes, offset_in_buffer);
+        }
+        else
+        {
+            render_stats::count_buffer_upload(bytes.size());
+            // GL_COPY_WRITE_BUFFER is not used for drawing, so binding to it doesn't mess with the vertex array that is currently bound
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset_in_buffer), static_cast<GLsizeiptr>(bytes.size()), bytes.data());
+        }
+    };
+
+    _sorted_ranges.resize(updates.ranges.size());
+    std::iota(_sorted_ranges.begin(), _sorted_ranges.end(), size_t{0});
+    std::sort(_sorted_ranges.begin(), _sorted_ranges.end(), [&](size_t a, size_t b) {
+        return updates.ranges[a].offset_in_buffer < updates.ranges[b].offset_in_buffer;
+    });
+
+    for (size_t first = 0; first < _sorted_ranges.size();)
+    {
+        size_t const begin = updates.ranges[_sorted_ranges[first]].offset_in_buffer;
+        size_t       end   = begin + updates.ranges[_sorted_ranges[first]].size;
+        size_t       last  = first + 1;
+        while (last < _sorted_ranges.size() && updates.ranges[_sorted_ranges[last]].offset_in_buffer <= end)
+        {
+            end = std::max(end, updates.ranges[_sorted_ranges[last]].offset_in_buffer + updates.ranges[_sorted_ranges[last]].size);
+            ++last;
+        }
+
+        if (last == first + 1)
+        {
+            auto const& range = updates.ranges[_sorted_ranges[first]];
+            upload_bytes(range.offset_in_buffer, std::span{updates.data}.subspan(range.offset_in_data, range.size));
+        }
+        else
+        {
+            // Applies the updates in the order in which they were requested, so that the last one wins where they overlap
+            std::sort(_sorted_ranges.begin() + static_cast<std::ptrdiff_t>(first), _sorted_ranges.begin() + static_cast<std::ptrdiff_t>(last));
+            _merged_data.resize(end - begin);
+            for (size_t i = first; i < last; ++i)
+            {
+                auto const& range = updates.ranges[_sorted_ranges[i]];
+                std::memcpy(_merged_data.data() + (range.offset_in_buffer - begin), updates.data.data() + range.offset_in_data, range.size);
+            }
+            upload_bytes(begin, _merged_data);
+        }
+        first = last;
+    }
+}
+
+void Mesh::delete_buffers()
 {
     glDeleteVertexArrays(1, &_vertex_array);
+    if (_arena != nullptr)
+    {
+        for (ArenaAllocation const& allocation : _arena_vertex_buffers)
+            _arena->free(allocation);
+        if (_arena_index_buffer.is_valid())
+            _arena->free(_arena_index_buffer);
+    }
     if (!_vertex_buffers.empty()) // Might have been moved-from
         glDeleteBuffers(static_cast<int>(_vertex_buffers.size()), _vertex_buffers.data());
     glDeleteBuffers(1, &_maybe_index_buffer);
 }
 
+Mesh::~Mesh()
+{
+    delete_buffers();
+}
+
 Mesh::Mesh(Mesh&& o) noexcept
-    : _vertex_array{o._vertex_array}
+    : _vertex_array{std::exchange(o._vertex_array, 0)}
     , _vertex_buffers{std::move(o._vertex_buffers)}
-    , _maybe_index_buffer{o._maybe_index_buffer}
-    , _triangles_count{o._triangles_count}
+    , _strides{std::move(o._strides)}
+    , _attribute_offsets{std::move(o._attribute_offsets)}
+    , _layouts{std::move(o._layouts)}
+    , _instance_divisors{std::move(o._instance_divisors)}
+    , _vertex_buffers_sizes{std::move(o._vertex_buffers_sizes)}
+    , _maybe_index_buffer{std::exchange(o._maybe_index_buffer, 0)}
+    , _has_index_buffer{o._has_index_buffer}
+    , _index_type{o._index_type}
+    , _index_offset{o._index_offset}
+    , _topology{o._topology}
+    , _arena{std::exchange(o._arena, nullptr)}
+    , _arena_vertex_buffers{std::move(o._arena_vertex_buffers)}
+    , _arena_index_buffer{o._arena_index_buffer}
+    , _arena_generation{o._arena_generation}
+    , _elements_count{o._elements_count}
+    , _pending_vertices_updates{std::move(o._pending_vertices_updates)}
+    , _pending_indices_updates{std::move(o._pending_indices_updates)}
+    , _has_pending_updates{std::exchange(o._has_pending_updates, false)}
+    , _sorted_ranges{std::move(o._sorted_ranges)}
+    , _merged_data{std::move(o._merged_data)}
 {
-    o._vertex_array = 0;
     o._vertex_buffers.resize(0);
-    o._maybe_index_buffer = 0;
 }
 
 auto Mesh::operator=(Mesh&& o) noexcept -> Mesh&
 {
     if (this != &o)
     {
-        // Delete this
-        glDeleteVertexArrays(1, &_vertex_array);
-        if (!_vertex_buffers.empty()) // Might have been moved-from
-            glDeleteBuffers(static_cast<int>(_vertex_buffers.size()), _vertex_buffers.data());
-        glDeleteBuffers(1, &_maybe_index_buffer);
+        delete_buffers();
+
+        _vertex_array         = std::exchange(o._vertex_array, 0);
+        _vertex_buffers       = std::move(o._vertex_buffers);
+        _strides              = std::move(o._strides);
+        _attribute_offsets    = std::move(o._attribute_offsets);
+        _layouts              = std::move(o._layouts);
+        _instance_divisors    = std::move(o._instance_divisors);
+        _vertex_buffers_sizes = std::move(o._vertex_buffers_sizes);
+        _maybe_index_buffer   = std::exchange(o._maybe_index_buffer, 0);
+        _has_index_buffer     = o._has_index_buffer;
+        _index_type           = o._index_type;
+        _index_offset         = o._index_offset;
+        _topology             = o._topology;
+        _arena                = std::exchange(o._arena, nullptr);
+        _arena_vertex_buffers = std::move(o._arena_vertex_buffers);
+        _arena_index_buffer   = o._arena_index_buffer;
+        _arena_generation     = o._arena_generation;
+        _elements_count       = o._elements_count;
 
-        // Move
-        _vertex_array       = o._vertex_array;
-        _vertex_buffers     = std::move(o._vertex_buffers);
-        _maybe_index_buffer = o._maybe_index_buffer;
-        _triangles_count    = o._triangles_count;
+        _pending_vertices_updates = std::move(o._pending_vertices_updates);
+        _pending_indices_updates  = std::move(o._pending_indices_updates);
+        _has_pending_updates      = std::exchange(o._has_pending_updates, false);
+        _sorted_ranges            = std::move(o._sorted_ranges);
+        _merged_data              = std::move(o._merged_data);
 
-        o._vertex_array = 0;
         o._vertex_buffers.resize(0);
-        o._maybe_index_buffer = 0;
     }
     return *this;
 }
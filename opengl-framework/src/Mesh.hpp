@@ -1,6 +1,12 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <type_traits>
 #include <variant>
 #include <vector>
+#include "GpuBufferArena.hpp"
 #include "glad/gl.h"
 
 namespace gl {
@@ -13,6 +19,8 @@ public:
     {}
 
     auto index() const -> int { return _index; }
+    /// Whether integer data is mapped to [0, 1] (unsigned) or [-1, 1] (signed) when read as a float by the shader
+    static auto normalized() -> GLboolean { return GL_FALSE; }
 
 private:
     int _index{};
@@ -69,6 +77,47 @@ public:
     static auto type() -> GLenum { return GL_INT; }
 };
 
+// Packed attributes, that take less memory and bandwidth than floats. They are still read as floats (vec2, vec4, etc.) by the shader.
+
+/// 2 half-precision floats (4 bytes). Fill them with glm::packHalf2x16().
+class HalfVec2 : public internal::VertexAttribute_Base {
+public:
+    using VertexAttribute_Base::VertexAttribute_Base;
+    static auto size() -> GLint { return 2; }
+    static auto type() -> GLenum { return GL_HALF_FLOAT; }
+};
+/// 4 half-precision floats (8 bytes). Fill them with glm::packHalf4x16().
+class HalfVec4 : public internal::VertexAttribute_Base {
+public:
+    using VertexAttribute_Base::VertexAttribute_Base;
+    static auto size() -> GLint { return 4; }
+    static auto type() -> GLenum { return GL_HALF_FLOAT; }
+};
+/// 4 bytes, each one mapped to [0, 1]. Typically a color. Fill them with glm::packUnorm4x8().
+class UNorm8Vec4 : public internal::VertexAttribute_Base {
+public:
+    using VertexAttribute_Base::VertexAttribute_Base;
+    static auto size() -> GLint { return 4; }
+    static auto type() -> GLenum { return GL_UNSIGNED_BYTE; }
+    static auto normalized() -> GLboolean { return GL_TRUE; }
+};
+/// 2 shorts (4 bytes), each one mapped to [-1, 1]. Typically a position, scaled by a uniform in the shader. Fill them with glm::packSnorm2x16().
+class SNorm16Vec2 : public internal::VertexAttribute_Base {
+public:
+    using VertexAttribute_Base::VertexAttribute_Base;
+    static auto size() -> GLint { return 2; }
+    static auto type() -> GLenum { return GL_SHORT; }
+    static auto normalized() -> GLboolean { return GL_TRUE; }
+};
+/// 4 shorts (8 bytes), each one mapped to [-1, 1]. Typically a position or a normal. Fill them with glm::packSnorm4x16().
+class SNorm16Vec4 : public internal::VertexAttribute_Base {
+public:
+    using VertexAttribute_Base::VertexAttribute_Base;
+    static auto size() -> GLint { return 4; }
+    static auto type() -> GLenum { return GL_SHORT; }
+    static auto normalized() -> GLboolean { return GL_TRUE; }
+};
+
 using Position2D = Vec2;
 using Position3D = Vec3;
 using Normal3D   = Vec3;
@@ -85,16 +134,113 @@ using AnyVertexAttribute = std::variant<
     VertexAttribute::Int,
     VertexAttribute::IVec2,
     VertexAttribute::IVec3,
-    VertexAttribute::IVec4>;
+    VertexAttribute::IVec4,
+    VertexAttribute::HalfVec2,
+    VertexAttribute::HalfVec4,
+    VertexAttribute::UNorm8Vec4,
+    VertexAttribute::SNorm16Vec2,
+    VertexAttribute::SNorm16Vec4>;
+
+namespace internal {
+/// Size of one vertex with this layout, in bytes
+auto vertex_size_in_bytes(std::vector<AnyVertexAttribute> const& layout) -> int;
+/// Describes the layout to the currently bound vertex array, reading from the buffer currently bound to GL_ARRAY_BUFFER, starting `offset` bytes into it.
+/// A `stride` of 0 means that the vertices are tightly packed.
+void set_vertex_attributes(std::vector<AnyVertexAttribute> const& layout, GLuint instance_divisor, size_t offset = 0, size_t stride = 0);
+} // namespace internal
+
+/// Non-owning view of the bytes of some vertex data. It can be created from a list of floats, or from a vector or span of any trivially copyable type (e.g. a struct describing a whole vertex).
+class VertexData {
+public:
+    VertexData(std::initializer_list<float> data) // NOLINT(*explicit-constructor, *explicit-conversions)
+        : _bytes{std::as_bytes(std::span{data.begin(), data.size()})}
+    {}
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    VertexData(std::span<T const> data) // NOLINT(*explicit-constructor, *explicit-conversions)
+        : _bytes{std::as_bytes(data)}
+    {}
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    VertexData(std::span<T> data) // NOLINT(*explicit-constructor, *explicit-conversions)
+        : _bytes{std::as_bytes(data)}
+    {}
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    VertexData(std::vector<T> const& data) // NOLINT(*explicit-constructor, *explicit-conversions)
+        : _bytes{std::as_bytes(std::span{data})}
+    {}
+
+    auto bytes() const -> std::span<std::byte const> { return _bytes; }
+
+private:
+    std::span<std::byte const> _bytes;
+};
+
+/// Non-owning view of some indices, either 32-bit or 16-bit. It can be created from a list of indices, or from a vector or span of uint32_t or uint16_t.
+class IndexData {
+public:
+    IndexData() = default;
+    IndexData(std::initializer_list<uint32_t> data) // NOLINT(*explicit-constructor, *explicit-conversions)
+        : _indices_32_bits{data.begin(), data.size()}
+    {}
+    IndexData(std::span<uint32_t const> data) // NOLINT(*explicit-constructor, *explicit-conversions)
+        : _indices_32_bits{data}
+    {}
+    IndexData(std::vector<uint32_t> const& data) // NOLINT(*explicit-constructor, *explicit-conversions)
+        : _indices_32_bits{data}
+    {}
+    /// Uploaded as is. Use 0xFFFF as the primitive restart index.
+    IndexData(std::span<uint16_t const> data) // NOLINT(*explicit-constructor, *explicit-conversions)
+        : _indices_16_bits{data}
+    {}
+    IndexData(std::vector<uint16_t> const& data) // NOLINT(*explicit-constructor, *explicit-conversions)
+        : _indices_16_bits{data}
+    {}
+
+    auto size() const -> size_t { return _indices_32_bits.size() + _indices_16_bits.size(); }
+    auto empty() const -> bool { return size() == 0; }
+    auto indices_32_bits() const -> std::span<uint32_t const> { return _indices_32_bits; }
+    auto indices_16_bits() const -> std::span<uint16_t const> { return _indices_16_bits; }
+
+private:
+    std::span<uint32_t const> _indices_32_bits{}; // Only one of them
+    std::span<uint16_t const> _indices_16_bits{}; // is not empty
+};
 
 struct VertexBuffer_Descriptor {
     std::vector<AnyVertexAttribute> const& layout; // NOLINT(*avoid-const-or-ref-data-members)
-    std::vector<float> const&              data;   // NOLINT(*avoid-const-or-ref-data-members)
+    /// Uploaded straight from there, without any intermediate copy
+    VertexData data;
+    /// 0 for per-vertex data. Otherwise the attributes advance once every `instance_divisor` instances, and the buffer doesn't count in the number of vertices of the mesh.
+    GLuint instance_divisor{0};
+    /// Distance between the beginnings of two consecutive vertices, in bytes. 0 means that the vertices only contain the attributes of the layout, tightly packed.
+    /// Allows using data that has more fields than the mesh needs (e.g. an array of structs), without copying the fields we need somewhere else first.
+    size_t stride{0};
+    /// Position of the first attribute of the layout in each vertex, in bytes
+    size_t offset{0};
 };
 
+/// How the vertices (or the indices, if there is an index buffer) are assembled into primitives
+enum class PrimitiveTopology : GLenum {
+    Triangles     = GL_TRIANGLES,      // 3 vertices per triangle
+    TriangleStrip = GL_TRIANGLE_STRIP, // Each vertex makes a triangle with the 2 previous ones
+    Lines         = GL_LINES,          // 2 vertices per line
+    LineStrip     = GL_LINE_STRIP,     // Each vertex makes a line with the previous one
+    Points        = GL_POINTS,
+};
+
+/// Put it in the index buffer of a TriangleStrip or LineStrip to end the current strip and start a new one, in the same draw call.
+static constexpr uint32_t primitive_restart_index = 0xFFFFFFFF;
+
 struct Mesh_Descriptor {
     std::vector<VertexBuffer_Descriptor> const& vertex_buffers; // NOLINT(*avoid-const-or-ref-data-members)
-    std::vector<uint32_t> const&                index_buffer{};
+    /// 32-bit indices are stored on the GPU as 16-bit ones when there are few enough vertices, which halves their size.
+    IndexData         index_buffer{};
+    PrimitiveTopology topology{PrimitiveTopology::Triangles};
+    /// When set, the vertex and index buffers are allocated in this arena instead of being created just for this mesh, which makes creating and destroying meshes much cheaper.
+    /// The arena must outlive the mesh.
+    GpuBufferArena* arena{nullptr};
 };
 
 class Mesh {
@@ -107,13 +253,68 @@ public:
     auto operator=(Mesh&&) noexcept -> Mesh&;
 
     void draw() const;
+    /// Draws the mesh `instances_count` times, in a single draw call. The per-instance attributes come from the vertex buffers that have an instance_divisor.
+    void draw_instanced(size_t instances_count) const;
+
+    /// Replaces all the content of a vertex buffer. The layout stays the same, but the size can change. Typically used to stream per-instance data each frame.
+    /// If the mesh has no index buffer, the number of vertices drawn follows the size of the new per-vertex data.
+    void set_vertex_buffer_data(size_t buffer_index, VertexData data);
+
+    /// Overwrites some of the vertices of a buffer, starting at `first_vertex`, without reallocating anything. `data` must contain whole vertices, laid out like the buffer (including its stride).
+    /// The updates are only sent to the GPU at the next draw, and the ones that overlap or touch each other are merged into a single upload. Typically used when editing a few vertices each frame.
+    void update_vertices(size_t buffer_index, size_t first_vertex, VertexData data);
+    /// Same as update_vertices(), for the index buffer. The indices are converted to the type that is stored on the GPU, so they must fit in 16 bits if the mesh stores them on 16 bits, which it does when the indices it was created with all fit (throws otherwise).
+    void update_indices(size_t first_index, IndexData data);
+    /// Sends the pending updates to the GPU. You don't need to call it yourself, draw() does it.
+    void flush_updates() const;
 
 private:
-    GLuint              _vertex_array{};
-    std::vector<GLuint> _vertex_buffers{};
-    GLuint              _maybe_index_buffer{};
+    void bind_buffers() const;
+    void delete_buffers();
+
+    /// Updates of a buffer that haven't been sent to the GPU yet, in the order in which they were requested
+    struct PendingUpdates {
+        struct Range {
+            size_t offset_in_buffer{}; // In bytes
+            size_t offset_in_data{};   // In bytes
+            size_t size{};             // In bytes
+        };
+        std::vector<Range>     ranges{};
+        std::vector<std::byte> data{};
+
+        void add(size_t offset_in_buffer, std::span<std::byte const> bytes);
+        void clear();
+    };
+    void upload(PendingUpdates const&, GLuint buffer, ArenaAllocation) const;
+
+private:
+    GLuint                                       _vertex_array{};
+    std::vector<GLuint>                          _vertex_buffers{};
+    std::vector<size_t>                          _strides{};           // In bytes
+    std::vector<size_t>                          _attribute_offsets{}; // In bytes
+    std::vector<std::vector<AnyVertexAttribute>> _layouts{};
+    std::vector<GLuint>                          _instance_divisors{};
+    std::vector<size_t>                          _vertex_buffers_sizes{}; // In bytes
+    GLuint                                       _maybe_index_buffer{};
+    bool                                         _has_index_buffer{};
+    GLenum                                       _index_type{GL_UNSIGNED_INT}; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    mutable size_t                               _index_offset{};              // In bytes
+    PrimitiveTopology                            _topology{PrimitiveTopology::Triangles};
+
+    // When allocated in an arena, instead of _vertex_buffers and _maybe_index_buffer
+    GpuBufferArena*              _arena{};
+    std::vector<ArenaAllocation> _arena_vertex_buffers{};
+    ArenaAllocation              _arena_index_buffer{};
+    mutable uint64_t             _arena_generation{}; // To know when our data has moved in the arena
+
+    size_t _elements_count{}; // Number of indices, or of vertices if there is no index buffer
 
-    size_t _triangles_count{};
+    mutable std::vector<PendingUpdates> _pending_vertices_updates{}; // One for each vertex buffer
+    mutable PendingUpdates              _pending_indices_updates{};
+    mutable bool                        _has_pending_updates{false};
+    // Scratch space of upload(), shared by all the buffers. Kept between the flushes so that updating the mesh each frame doesn't allocate.
+    mutable std::vector<size_t>    _sorted_ranges{}; // Indices in PendingUpdates::ranges
+    mutable std::vector<std::byte> _merged_data{};
 };
 
 } // namespace gl
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "MeshPool.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <numeric>
+#include <utility>
+#include "RenderStats.hpp"
+#include "glad/gl.h"
+
+namespace gl {
+
+void DrawList::add(PooledMesh const& mesh, std::span<std::byte const> instance_data)
+{
+    _items.push_back({.mesh = mesh, .instance_data_offset = _instances_data.size()});
+    _instances_data.insert(_instances_data.end(), instance_data.begin(), instance_data.end());
+}
+
+void DrawList::clear()
+{
+    _items.clear();
+    _instances_data.clear();
+}
+
+MeshPool::MeshPool(MeshPool_Descriptor const& desc)
+    : _layout{desc.layout}
+    , _instance_layout{desc.instance_layout}
+    , _vertex_stride{static_cast<size_t>(internal::vertex_size_in_bytes(desc.layout))}
+    , _instance_stride{static_cast<size_t>(internal::vertex_size_in_bytes(desc.instance_layout))}
+    // Allocating whole vertices lets us draw with a base vertex
+    , _vertices{{.unit_size = _vertex_stride, .initial_capacity = desc.vertices_capacity * _vertex_stride}}
+    , _indices{{.unit_size = sizeof(uint32_t), .initial_capacity = desc.indices_capacity * sizeof(uint32_t)}}
+    , _supports_multi_draw_indirect{GLAD_GL_VERSION_4_3 != 0}
+{
+    glGenVertexArrays(1, &_vertex_array);
+    glBindVertexArray(_vertex_array);
+
+    glGenBuffers(1, &_instance_buffer);
+    if (!_instance_layout.empty())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _instance_buffer);
+        internal::set_vertex_attributes(_instance_layout, 1);
+    }
+    if (_supports_multi_draw_indirect)
+        glGenBuffers(1, &_indirect_buffer);
+
+    bind_buffers();
+}
+
+MeshPool::~MeshPool()
+{
+    glDeleteVertexArrays(1, &_vertex_array);
+    glDeleteBuffers(1, &_instance_buffer);
+    glDeleteBuffers(1, &_indirect_buffer);
+}
+
+MeshPool::MeshPool(MeshPool&& o) noexcept
+    : _layout{std::move(o._layout)}
+    , _instance_layout{std::move(o._instance_layout)}
+    , _vertex_stride{o._vertex_stride}
+    , _instance_stride{o._instance_stride}
+    , _vertices{std::move(o._vertices)}
+    , _indices{std::move(o._indices)}
+    , _bound_vertices_generation{o._bound_vertices_generation}
+    , _bound_indices_generation{o._bound_indices_generation}
+    , _vertex_array{std::exchange(o._vertex_array, 0)}
+    , _instance_buffer{std::exchange(o._instance_buffer, 0)}
+    , _indirect_buffer{std::exchange(o._indirect_buffer, 0)}
+    , _meshes{std::move(o._meshes)}
+    , _free_ids{std::move(o._free_ids)}
+    , _supports_multi_draw_indirect{o._supports_multi_draw_indirect}
+{
+}
+
+auto MeshPool::operator=(MeshPool&& o) noexcept -> MeshPool&
+{
+    if (this != &o)
+    {
+        glDeleteVertexArrays(1, &_vertex_array);
+        glDeleteBuffers(1, &_instance_buffer);
+        glDeleteBuffers(1, &_indirect_buffer);
+
+        _layout                       = std::move(o._layout);
+        _instance_layout              = std::move(o._instance_layout);
+        _vertex_stride                = o._vertex_stride;
+        _instance_stride              = o._instance_stride;
+        _vertices                     = std::move(o._vertices);
+        _indices                      = std::move(o._indices);
+        _vertex_array                 = std::exchange(o._vertex_array, 0);
+        _instance_buffer              = std::exchange(o._instance_buffer, 0);
+        _indirect_buffer              = std::exchange(o._indirect_buffer, 0);
+        _meshes                       = std::move(o._meshes);
+        _free_ids                     = std::move(o._free_ids);
+        _supports_multi_draw_indirect = o._supports_multi_draw_indirect;
+        bind_buffers(); // The generations of the arenas have changed when moving them
+    }
+    return *this;
+}
+
+/// Points the vertex array to the current buffers of the arenas, which change when they grow or get defragmented
+void MeshPool::bind_buffers()
+{
+    glBindVertexArray(_vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, _vertices.buffer());
+    internal::set_vertex_attributes(_layout, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indices.buffer());
+    _bound_vertices_generation = _vertices.generation();
+    _bound_indices_generation  = _indices.generation();
+}
+
+auto MeshPool::add(VertexData vertices, std::span<uint32_t const> indices) -> PooledMesh
+{
+    auto const bytes = vertices.bytes();
+    assert(bytes.size() % _vertex_stride == 0 && "The size of the data is not a multiple of the size of a vertex. Make sure that it matches the layout of the pool.");
+    assert(indices.size() % 3 == 0 && "You must provide 3 indices for each triangle");
+
+    Entry const entry{
+        .vertices      = _vertices.allocate(bytes.size()),
+        .indices       = _indices.allocate(indices.size_bytes()),
+        .indices_count = static_cast<GLuint>(indices.size()),
+    };
+    _vertices.upload(entry.vertices, bytes);
+    _indices.upload(entry.indices, std::as_bytes(indices));
+
+    PooledMesh mesh{};
+    if (!_free_ids.empty())
+    {
+        mesh.id = _free_ids.back();
+        _free_ids.pop_back();
+        _meshes[mesh.id] = entry;
+    }
+    else
+    {
+        mesh.id = static_cast<uint32_t>(_meshes.size());
+        _meshes.push_back(entry);
+    }
+    return mesh;
+}
+
+void MeshPool::remove(PooledMesh mesh)
+{
+    Entry& entry = _meshes.at(mesh.id);
+    assert(entry.vertices.is_valid() && "This mesh has already been removed");
+    _vertices.free(entry.vertices);
+    _indices.free(entry.indices);
+    entry = Entry{};
+    _free_ids.push_back(mesh.id);
+}
+
+void MeshPool::clear()
+{
+    for (uint32_t id = 0; id < _meshes.size(); ++id)
+    {
+        if (_meshes[id].vertices.is_valid())
+            remove(PooledMesh{id});
+    }
+}
+
+void MeshPool::defragment()
+{
+    // The meshes only store ids of allocations, which stay the same. The new offsets will be read by the next draw().
+    _vertices.defragment();
+    _indices.defragment();
+}
+
+void MeshPool::draw(DrawList const& list)
+{
+    if (list.empty())
+        return;
+
+    // Sort by mesh, so that all the instances of a mesh are next to each other and can be drawn by the same command
+    _sorted_items.resize(list._items.size());
+    std::iota(_sorted_items.begin(), _sorted_items.end(), size_t{0});
+    std::stable_sort(_sorted_items.begin(), _sorted_items.end(), [&](size_t a, size_t b) {
+        return list._items[a].mesh.id < list._items[b].mesh.id;
+    });
+
+    _sorted_instances_data.resize(_sorted_items.size() * _instance_stride);
+    _commands.clear();
+    PooledMesh previous_mesh{};
+    for (size_t i = 0; i < _sorted_items.size(); ++i)
+    {
+        DrawList::Item const& item = list._items[_sorted_items[i]];
+        if (_instance_stride != 0)
+        {
+            assert(item.instance_data_offset + _instance_stride <= list._instances_data.size() && "Missing instance data. Make sure you gave DrawList::add() some data that matches the instance_layout of the pool.");
+            std::memcpy(_sorted_instances_data.data() + i * _instance_stride, list._instances_data.data() + item.instance_data_offset, _instance_stride);
+        }
+
+        if (!_commands.empty() && item.mesh.id == previous_mesh.id)
+        {
+            ++_commands.back().instance_count;
+        }
+        else
+        {
+            Entry const& entry = _meshes.at(item.mesh.id);
+            assert(entry.vertices.is_valid() && "This mesh has been removed from the pool");
+            _commands.push_back({
+                .count          = entry.indices_count,
+                .instance_count = 1,
+                .first_index    = static_cast<GLuint>(_indices.offset_in_bytes(entry.indices) / sizeof(uint32_t)),
+                .base_vertex    = static_cast<GLint>(_vertices.offset_in_bytes(entry.vertices) / _vertex_stride),
+                .base_instance  = static_cast<GLuint>(i),
+            });
+        }
+        previous_mesh = item.mesh;
+    }
+
+    if (_vertices.generation() != _bound_vertices_generation || _indices.generation() != _bound_indices_generation)
+        bind_buffers();
+    glBindVertexArray(_vertex_array);
+    if (_instance_stride != 0)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _instance_buffer);
+        render_stats::count_buffer_upload(_sorted_instances_data.size());
+        // Reallocating lets the driver give us new memory instead of waiting for the previous draw to be done with it
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_sorted_instances_data.size()), _sorted_instances_data.data(), GL_STREAM_DRAW);
+    }
+
+    if (_supports_multi_draw_indirect)
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirect_buffer);
+        render_stats::count_buffer_upload(_commands.size() * sizeof(DrawCommand));
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(_commands.size() * sizeof(DrawCommand)), _commands.data(), GL_STREAM_DRAW);
+        render_stats::count(render_stats::Counter::DrawCalls);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(_commands.size()), 0);
+    }
+    else
+    {
+        // No base instance before OpenGL 4.2: we move the instance attributes to the first instance of each command instead
+        for (DrawCommand const& command : _commands)
+        {
+            if (_instance_stride != 0)
+                internal::set_vertex_attributes(_instance_layout, 1, command.base_instance * _instance_stride);
+            render_stats::count(render_stats::Counter::DrawCalls);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(command.count), GL_UNSIGNED_INT, reinterpret_cast<void*>(command.first_index * sizeof(uint32_t)), static_cast<GLsizei>(command.instance_count), command.base_vertex); // NOLINT(*reinterpret-cast, performance-no-int-to-ptr)
+        }
+    }
+}
+
+} // namespace gl
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "GpuBufferArena.hpp"
+#include "Mesh.hpp"
+
+namespace gl {
+
+struct MeshPool_Descriptor {
+    /// Layout of the vertices of all the meshes of the pool
+    std::vector<AnyVertexAttribute> const& layout; // NOLINT(*avoid-const-or-ref-data-members)
+    /// Layout of the per-instance data given to DrawList::add(). Can be empty.
+    std::vector<AnyVertexAttribute> const& instance_layout{}; // NOLINT(*avoid-const-or-ref-data-members)
+    /// Initial size of the shared buffers. They grow automatically when needed, but growing copies all the meshes.
+    size_t vertices_capacity{4096};
+    size_t indices_capacity{4096 * 3};
+};
+
+/// A mesh stored in a MeshPool. It's just an id, so it's cheap to copy around, and it stays valid when the pool moves the meshes around (see MeshPool::defragment()).
+struct PooledMesh {
+    uint32_t id{};
+};
+
+/// Records which meshes to draw, with their per-instance data, so that a MeshPool can draw all of them in a single call.
+/// Reuse the same DrawList each frame (clear() it) so that its memory gets reused too.
+class DrawList {
+public:
+    void add(PooledMesh const& mesh, std::span<std::byte const> instance_data = {});
+    template<typename Instance>
+        requires std::is_trivially_copyable_v<Instance>
+    void add(PooledMesh const& mesh, Instance const& instance)
+    {
+        add(mesh, std::as_bytes(std::span{&instance, 1}));
+    }
+
+    void clear();
+    auto size() const -> size_t { return _items.size(); }
+    auto empty() const -> bool { return _items.empty(); }
+
+private:
+    friend class MeshPool;
+    struct Item {
+        PooledMesh mesh;
+        size_t     instance_data_offset; // In bytes, in _instances_data
+    };
+    std::vector<Item>      _items{};
+    std::vector<std::byte> _instances_data{};
+};
+
+/// Stores many small meshes in a few shared buffers, with a single vertex array, so that they can all be drawn with one call to glMultiDrawElementsIndirect().
+/// Without OpenGL 4.3 (e.g. on MacOS), draw() still works but issues one draw call per mesh.
+class MeshPool {
+public:
+    explicit MeshPool(MeshPool_Descriptor const&);
+    ~MeshPool();
+    MeshPool(MeshPool const&)                    = delete; // You cannot copy a MeshPool.
+    auto operator=(MeshPool const&) -> MeshPool& = delete; // But you can move it, using std::move(my_pool)
+    MeshPool(MeshPool&&) noexcept;
+    auto operator=(MeshPool&&) noexcept -> MeshPool&;
+
+    /// The vertices must follow the layout of the pool. Indices are relative to the first of these vertices, 3 per triangle.
+    auto add(VertexData vertices, std::span<uint32_t const> indices) -> PooledMesh;
+    /// Gives the space used by the mesh back to the pool. The mesh must not be drawn anymore.
+    void remove(PooledMesh);
+    /// Removes all the meshes
+    void clear();
+
+    /// Draws everything in the list, in as few draw calls as possible. Instances of the same mesh are merged into a single instanced draw.
+    void draw(DrawList const&);
+
+    /// Packs all the meshes at the beginning of the buffers, so that the free space left by removed meshes can be used by big ones again.
+    /// Worth it when the fragmentation() of the stats gets high. The PooledMesh stay valid.
+    void defragment();
+    auto vertices_stats() const -> GpuBufferArena_Stats { return _vertices.stats(); }
+    auto indices_stats() const -> GpuBufferArena_Stats { return _indices.stats(); }
+
+private:
+    void bind_buffers();
+
+private:
+    std::vector<AnyVertexAttribute> _layout;
+    std::vector<AnyVertexAttribute> _instance_layout;
+    size_t                          _vertex_stride{};
+    size_t                          _instance_stride{};
+
+    GpuBufferArena _vertices;
+    GpuBufferArena _indices;
+    uint64_t       _bound_vertices_generation{}; // To know when the vertex array
+    uint64_t       _bound_indices_generation{};  // must be pointed to the new buffers
+
+    GLuint _vertex_array{};
+    GLuint _instance_buffer{};
+    GLuint _indirect_buffer{};
+
+    struct Entry {
+        ArenaAllocation vertices{};
+        ArenaAllocation indices{};
+        GLuint          indices_count{};
+    };
+    std::vector<Entry>    _meshes{}; // Indexed by PooledMesh::id
+    std::vector<uint32_t> _free_ids{};
+
+    bool _supports_multi_draw_indirect{};
+
+    /// Same layout as the DrawElementsIndirectCommand expected by glMultiDrawElementsIndirect()
+    struct DrawCommand {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first_index;
+        GLint  base_vertex;
+        GLuint base_instance;
+    };
+    // Reused across frames by draw()
+    std::vector<size_t>      _sorted_items{};
+    std::vector<std::byte>   _sorted_instances_data{};
+    std::vector<DrawCommand> _commands{};
+};
+
+} // namespace gl
@@ -0,0 +1,274 @@
+#include "OffsetAllocator.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace gl {
+
+static constexpr uint32_t mantissa_bits  = 3;
+static constexpr uint32_t mantissa_value = 1 << mantissa_bits;
+static constexpr uint32_t mantissa_mask  = mantissa_value - 1;
+
+/// Index of the smallest bin whose blocks are all at least `size` big
+static auto bin_rounding_up(uint32_t size) -> uint32_t
+{
+    if (size < mantissa_value)
+        return size;
+    uint32_t const highest_bit    = 31 - static_cast<uint32_t>(std::countl_zero(size));
+    uint32_t const mantissa_start = highest_bit - mantissa_bits;
+    uint32_t       mantissa       = (size >> mantissa_start) & mantissa_mask;
+    if ((size & ((1u << mantissa_start) - 1)) != 0)
+        ++mantissa; // Can overflow into the exponent, which is what we want
+    return ((mantissa_start + 1) << mantissa_bits) + mantissa;
+}
+
+/// Index of the bin in which a free block of `size` is stored
+static auto bin_rounding_down(uint32_t size) -> uint32_t
+{
+    if (size < mantissa_value)
+        return size;
+    uint32_t const highest_bit    = 31 - static_cast<uint32_t>(std::countl_zero(size));
+    uint32_t const mantissa_start = highest_bit - mantissa_bits;
+    uint32_t const mantissa       = (size >> mantissa_start) & mantissa_mask;
+    return ((mantissa_start + 1) << mantissa_bits) | mantissa;
+}
+
+OffsetAllocator::OffsetAllocator(uint32_t capacity)
+    : _capacity{capacity}
+{
+    reset();
+}
+
+void OffsetAllocator::reset()
+{
+    _nodes.clear();
+    _unused_nodes.clear();
+    _bins.fill(invalid_node);
+    _bins_masks.fill(0);
+    _groups_mask       = 0;
+    _last_node         = invalid_node;
+    _used              = 0;
+    _allocations_count = 0;
+    _free_blocks_count = 0;
+    if (_capacity > 0)
+    {
+        _last_node                = new_node();
+        _nodes[_last_node].offset = 0;
+        _nodes[_last_node].size   = _capacity;
+        insert_free_node(_last_node);
+    }
+}
+
+auto OffsetAllocator::new_node() -> uint32_t
+{
+    if (!_unused_nodes.empty())
+    {
+        uint32_t const node = _unused_nodes.back();
+        _unused_nodes.pop_back();
+        _nodes[node] = Node{};
+        return node;
+    }
+    _nodes.emplace_back();
+    return static_cast<uint32_t>(_nodes.size() - 1);
+}
+
+void OffsetAllocator::insert_free_node(uint32_t node)
+{
+    uint32_t const bin = bin_rounding_down(_nodes[node].size);
+    _nodes[node].is_used       = false;
+    _nodes[node].previous_free = invalid_node;
+    _nodes[node].next_free     = _bins[bin];
+    if (_bins[bin] != invalid_node)
+        _nodes[_bins[bin]].previous_free = node;
+    _bins[bin] = node;
+    _bins_masks[bin / bins_per_group] |= static_cast<uint8_t>(1u << (bin % bins_per_group));
+    _groups_mask |= 1u << (bin / bins_per_group);
+    ++_free_blocks_count;
+}
+
+void OffsetAllocator::remove_free_node(uint32_t node)
+{
+    Node const& n = _nodes[node];
+    if (n.previous_free != invalid_node)
+    {
+        _nodes[n.previous_free].next_free = n.next_free;
+    }
+    else
+    {
+        uint32_t const bin = bin_rounding_down(n.size);
+        assert(_bins[bin] == node);
+        _bins[bin] = n.next_free;
+        if (_bins[bin] == invalid_node)
+        {
+            _bins_masks[bin / bins_per_group] &= static_cast<uint8_t>(~(1u << (bin % bins_per_group)));
+            if (_bins_masks[bin / bins_per_group] == 0)
+                _groups_mask &= ~(1u << (bin / bins_per_group));
+        }
+    }
+    if (n.next_free != invalid_node)
+        _nodes[n.next_free].previous_free = n.previous_free;
+    --_free_blocks_count;
+}
+
+auto OffsetAllocator::find_free_bin(uint32_t min_bin) const -> uint32_t
+{
+    uint32_t const group = min_bin / bins_per_group;
+    if (group >= groups_count)
+        return invalid_node;
+
+    // In the same group
+    uint32_t const bins = _bins_masks[group] & (0xFFu << (min_bin % bins_per_group));
+    if (bins != 0)
+        return group * bins_per_group + static_cast<uint32_t>(std::countr_zero(bins));
+
+    // In the next group that has a free block: any of its bins is big enough
+    uint32_t const groups = group + 1 < groups_count ? _groups_mask & (~0u << (group + 1)) : 0;
+    if (groups == 0)
+        return invalid_node;
+    auto const next_group = static_cast<uint32_t>(std::countr_zero(groups));
+    return next_group * bins_per_group + static_cast<uint32_t>(std::countr_zero(static_cast<uint32_t>(_bins_masks[next_group])));
+}
+
+auto OffsetAllocator::allocate(uint32_t size) -> std::optional<OffsetAllocation>
+{
+    assert(size > 0);
+    uint32_t node = invalid_node;
+    if (uint32_t const bin = find_free_bin(bin_rounding_up(size)); bin != invalid_node)
+    {
+        node = _bins[bin];
+    }
+    else
+    {
+        // The bin of `size` itself also contains blocks smaller than `size`, so it is only searched as a last resort, block by block
+        for (uint32_t candidate = _bins[bin_rounding_down(size)]; candidate != invalid_node; candidate = _nodes[candidate].next_free)
+        {
+            if (_nodes[candidate].size >= size)
+            {
+                node = candidate;
+                break;
+            }
+        }
+        if (node == invalid_node)
+            return std::nullopt;
+    }
+
+    remove_free_node(node);
+    uint32_t const remaining_size = _nodes[node].size - size;
+    _nodes[node].size             = size;
+    _nodes[node].is_used          = true;
+
+    // Give back what we don't need
+    if (remaining_size > 0)
+    {
+        uint32_t const remainder            = new_node(); // Might reallocate _nodes, so we don't keep references to it
+        _nodes[remainder].offset            = _nodes[node].offset + size;
+        _nodes[remainder].size              = remaining_size;
+        _nodes[remainder].previous_neighbor = node;
+        _nodes[remainder].next_neighbor     = _nodes[node].next_neighbor;
+        if (_nodes[node].next_neighbor != invalid_node)
+            _nodes[_nodes[node].next_neighbor].previous_neighbor = remainder;
+        else
+            _last_node = remainder;
+        _nodes[node].next_neighbor = remainder;
+        insert_free_node(remainder);
+    }
+
+    _used += size;
+    ++_allocations_count;
+    return OffsetAllocation{.offset = _nodes[node].offset, .size = size, .node = node};
+}
+
+void OffsetAllocator::free(OffsetAllocation const& allocation)
+{
+    uint32_t const node = allocation.node;
+    assert(node < _nodes.size() && _nodes[node].is_used && _nodes[node].offset == allocation.offset && "This allocation doesn't belong to this allocator, or has already been freed");
+    _used -= _nodes[node].size;
+    --_allocations_count;
+
+    // Merge with the free blocks around it
+    uint32_t const previous = _nodes[node].previous_neighbor;
+    if (previous != invalid_node && !_nodes[previous].is_used)
+    {
+        remove_free_node(previous);
+        _nodes[node].offset = _nodes[previous].offset;
+        _nodes[node].size += _nodes[previous].size;
+        _nodes[node].previous_neighbor = _nodes[previous].previous_neighbor;
+        if (_nodes[node].previous_neighbor != invalid_node)
+            _nodes[_nodes[node].previous_neighbor].next_neighbor = node;
+        _unused_nodes.push_back(previous);
+    }
+    uint32_t const next = _nodes[node].next_neighbor;
+    if (next != invalid_node && !_nodes[next].is_used)
+    {
+        remove_free_node(next);
+        _nodes[node].size += _nodes[next].size;
+        _nodes[node].next_neighbor = _nodes[next].next_neighbor;
+        if (_nodes[node].next_neighbor != invalid_node)
+            _nodes[_nodes[node].next_neighbor].previous_neighbor = node;
+        else
+            _last_node = node;
+        _unused_nodes.push_back(next);
+    }
+    insert_free_node(node);
+}
+
+void OffsetAllocator::grow(uint32_t new_capacity)
+{
+    assert(new_capacity >= _capacity);
+    uint32_t const added_size = new_capacity - _capacity;
+    if (added_size == 0)
+        return;
+
+    if (_last_node != invalid_node && !_nodes[_last_node].is_used)
+    {
+        remove_free_node(_last_node);
+        _nodes[_last_node].size += added_size;
+        insert_free_node(_last_node);
+    }
+    else
+    {
+        uint32_t const node            = new_node();
+        _nodes[node].offset            = _capacity;
+        _nodes[node].size              = added_size;
+        _nodes[node].previous_neighbor = _last_node;
+        if (_last_node != invalid_node)
+            _nodes[_last_node].next_neighbor = node;
+        _last_node = node;
+        insert_free_node(node);
+    }
+    _capacity = new_capacity;
+}
+
+auto OffsetAllocator::stats() const -> OffsetAllocator_Stats
+{
+    OffsetAllocator_Stats stats{
+        .capacity          = _capacity,
+        .used              = _used,
+        .allocations_count = _allocations_count,
+        .free_blocks_count = _free_blocks_count,
+    };
+    // The largest block is in the highest non-empty bin, but that bin also contains smaller blocks
+    if (_groups_mask != 0)
+    {
+        uint32_t const group = 31 - static_cast<uint32_t>(std::countl_zero(_groups_mask));
+        uint32_t const bin   = group * bins_per_group + 31 - static_cast<uint32_t>(std::countl_zero(static_cast<uint32_t>(_bins_masks[group])));
+        for (uint32_t node = _bins[bin]; node != invalid_node; node = _nodes[node].next_free)
+            stats.largest_free_block = std::max(stats.largest_free_block, _nodes[node].size);
+    }
+    return stats;
+}
+
+auto OffsetAllocator::allocations() const -> std::vector<OffsetAllocation>
+{
+    std::vector<OffsetAllocation> allocations{};
+    allocations.reserve(_allocations_count);
+    for (uint32_t node = _last_node; node != invalid_node; node = _nodes[node].previous_neighbor)
+    {
+        if (_nodes[node].is_used)
+            allocations.push_back({.offset = _nodes[node].offset, .size = _nodes[node].size, .node = node});
+    }
+    std::reverse(allocations.begin(), allocations.end());
+    return allocations;
+}
+
+} // namespace gl
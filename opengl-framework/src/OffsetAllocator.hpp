@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace gl {
+
+struct OffsetAllocation {
+    uint32_t offset{};
+    uint32_t size{};
+    uint32_t node{}; // Used internally by the allocator
+};
+
+struct OffsetAllocator_Stats {
+    uint32_t capacity{};
+    uint32_t used{};
+    uint32_t allocations_count{};
+    uint32_t free_blocks_count{};
+    uint32_t largest_free_block{};
+};
+
+/// Hands out ranges of [0, capacity), in O(1), without touching the memory it manages. Typically used to suballocate a big GPU buffer.
+/// Two-Level Segregated Fit: free blocks are sorted in 256 bins, whose sizes follow a tiny floating-point format (3 bits of mantissa), so that finding a block big enough is just a couple of bit scans.
+/// Neighbouring free blocks are merged when freeing.
+class OffsetAllocator {
+public:
+    explicit OffsetAllocator(uint32_t capacity = 0);
+
+    /// Returns nullopt if there is no free block big enough (even if there is enough free space in total: see OffsetAllocator_Stats::largest_free_block).
+    [[nodiscard]] auto allocate(uint32_t size) -> std::optional<OffsetAllocation>;
+    void               free(OffsetAllocation const&);
+    /// Frees everything
+    void reset();
+    /// Adds space at the end. Existing allocations don't move.
+    void grow(uint32_t new_capacity);
+
+    auto capacity() const -> uint32_t { return _capacity; }
+    auto stats() const -> OffsetAllocator_Stats;
+    /// All the current allocations, sorted by offset
+    auto allocations() const -> std::vector<OffsetAllocation>;
+
+    static constexpr uint32_t invalid_node = 0xFFFFFFFF;
+
+private:
+    struct Node {
+        uint32_t offset{};
+        uint32_t size{};
+        uint32_t previous_neighbor{invalid_node}; // Blocks just before and after this one in memory
+        uint32_t next_neighbor{invalid_node};     //
+        uint32_t previous_free{invalid_node};     // Other free blocks in the same bin
+        uint32_t next_free{invalid_node};         //
+        bool     is_used{false};
+    };
+
+    auto new_node() -> uint32_t;
+    void insert_free_node(uint32_t node);
+    void remove_free_node(uint32_t node);
+    auto find_free_bin(uint32_t min_bin) const -> uint32_t;
+
+    static constexpr uint32_t bins_per_group = 8;
+    static constexpr uint32_t groups_count   = 32;
+    static constexpr uint32_t bins_count     = groups_count * bins_per_group;
+
+    uint32_t                          _capacity{};
+    std::vector<Node>                 _nodes{};
+    std::vector<uint32_t>             _unused_nodes{};
+    std::array<uint32_t, bins_count>  _bins{};                  // First free node of each bin
+    std::array<uint8_t, groups_count> _bins_masks{};            // Which bins of each group have a free node
+    uint32_t                          _groups_mask{};           // Which groups have a free node
+    uint32_t                          _last_node{invalid_node}; // The block with the highest offset
+    uint32_t                          _used{};
+    uint32_t                          _allocations_count{};
+    uint32_t                          _free_blocks_count{};
+};
+
+} // namespace gl
@@ -0,0 +1,398 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include "glad/gl.h"
+#include "handle_error.hpp"
+
+namespace gl::profiler {
+
+namespace {
+
+constexpr size_t   events_per_thread = size_t{1} << 14; // Must be a power of 2. Older events get overwritten if we don't read them fast enough.
+constexpr size_t   frames_in_flight  = 4;               // Number of frames we wait before reading the GPU timings back
+constexpr size_t   history_size      = 300;             // Number of frames kept for save_chrome_trace()
+constexpr uint32_t gpu_thread_id     = 0xFFFFFFFF;
+
+auto now_ns() -> uint64_t
+{
+    static auto const start = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+struct Event {
+    char const* name{};
+    uint64_t    begin_ns{};
+    uint64_t    end_ns{};
+    uint32_t    thread_id{}; // gpu_thread_id for GPU events
+};
+
+/// A slot of the ring buffer of a thread. The reader can copy it while the writer overwrites it (it is a seqlock): the sequence number tells the reader whether its copy is torn.
+/// All the fields are atomics so that this is not a data race, but they are only accessed with relaxed loads and stores, which are plain moves on x86 and ARM.
+struct EventSlot {
+    std::atomic<uint64_t>    sequence{0}; // 2 * (index + 1) once the event `index` has been written, odd while an event is being written
+    std::atomic<char const*> name{};
+    std::atomic<uint64_t>    begin_ns{};
+    std::atomic<uint64_t>    end_ns{};
+
+    void write(uint64_t index, char const* event_name, uint64_t event_begin_ns, uint64_t event_end_ns)
+    {
+        sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        name.store(event_name, std::memory_order_relaxed);
+        begin_ns.store(event_begin_ns, std::memory_order_relaxed);
+        end_ns.store(event_end_ns, std::memory_order_relaxed);
+        sequence.store(2 * (index + 1), std::memory_order_release);
+    }
+
+    /// Returns false if the slot doesn't contain the event `index` anymore, or if the writer started overwriting it while we were copying it
+    auto read(uint64_t index, Event& event) const -> bool
+    {
+        uint64_t const expected_sequence = 2 * (index + 1);
+        if (sequence.load(std::memory_order_acquire) != expected_sequence)
+            return false;
+        event.name     = name.load(std::memory_order_relaxed);
+        event.begin_ns = begin_ns.load(std::memory_order_relaxed);
+        event.end_ns   = end_ns.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) == expected_sequence;
+    }
+};
+
+/// Ring buffer of events, written by a single thread and read by the one that calls new_frame()
+struct ThreadEvents {
+    std::vector<EventSlot> events = std::vector<EventSlot>(events_per_thread);
+    std::atomic<uint64_t> write_index{0};
+    uint64_t              read_index{0};
+    uint32_t              thread_id{};
+    std::atomic<bool>     is_owned{false}; // Whether a thread is currently writing to it. Threads that exit give their buffer to the next thread that gets created.
+};
+
+struct GpuScopeQueries {
+    char const* name{};
+    GLuint      begin_query{};
+    GLuint      end_query{};
+    bool        has_ended{false};
+};
+
+/// The GPU scopes of one of the frames in flight
+struct GpuFrame {
+    uint64_t                     frame_index{};
+    std::vector<GLuint>          queries{}; // Never deleted, reused by the next frames that use this slot
+    size_t                       used_queries_count{};
+    std::vector<GpuScopeQueries> scopes{};
+    int64_t                      gpu_to_cpu_offset_ns{}; // GPU timestamps are not measured from the same origin as now_ns()
+
+    auto next_query() -> GLuint
+    {
+        if (used_queries_count == queries.size())
+        {
+            queries.emplace_back();
+            glGenQueries(1, &queries.back());
+        }
+        return queries[used_queries_count++];
+    }
+};
+
+struct FrameRecord {
+    Frame_Profile      profile{};
+    uint64_t           begin_ns{};
+    std::vector<Event> events{};
+    bool               is_waiting_for_gpu{false};
+};
+
+struct State {
+    std::atomic<bool> is_enabled{false};
+
+    std::mutex                                 threads_mutex{};
+    std::vector<std::unique_ptr<ThreadEvents>> threads{};
+
+    // Only used by the thread that calls new_frame(), which must be the one that owns the OpenGL context
+    uint64_t                              frame_index{0};
+    uint64_t                              frame_begin_ns{now_ns()};
+    std::array<GpuFrame, frames_in_flight> gpu_frames{};
+    std::deque<FrameRecord>               history{};
+    Frame_Profile                         latest_frame{};
+};
+
+auto state() -> State&
+{
+    static auto instance = State{};
+    return instance;
+}
+
+auto acquire_thread_events() -> ThreadEvents&
+{
+    std::scoped_lock lock{state().threads_mutex};
+    for (auto const& thread : state().threads)
+    {
+        bool is_owned = false;
+        if (thread->is_owned.compare_exchange_strong(is_owned, true, std::memory_order_acquire))
+            return *thread;
+    }
+    auto& thread     = *state().threads.emplace_back(std::make_unique<ThreadEvents>());
+    thread.thread_id = static_cast<uint32_t>(state().threads.size() - 1);
+    thread.is_owned.store(true, std::memory_order_relaxed);
+    return thread;
+}
+
+struct ThreadEventsOwner { // NOLINT(*special-member-functions)
+    ThreadEvents* events{nullptr};
+
+    ~ThreadEventsOwner()
+    {
+        if (events != nullptr)
+            events->is_owned.store(false, std::memory_order_release);
+    }
+};
+
+auto thread_events() -> ThreadEvents&
+{
+    thread_local ThreadEventsOwner owner{};
+    if (owner.events == nullptr)
+        owner.events = &acquire_thread_events();
+    return *owner.events;
+}
+
+/// Reads all the events that have been written since the last call, in order
+void drain(ThreadEvents& thread, std::vector<Event>& out)
+{
+    uint64_t const write_index = thread.write_index.load(std::memory_order_acquire);
+    uint64_t const begin       = std::max(thread.read_index, write_index > events_per_thread ? write_index - events_per_thread : 0);
+    for (uint64_t i = begin; i < write_index; ++i)
+    {
+        Event event{.thread_id = thread.thread_id};
+        if (thread.events[i & (events_per_thread - 1)].read(i, event)) // Otherwise the writer lapped us while we were copying, and the event is lost
+            out.push_back(event);
+    }
+    thread.read_index = write_index;
+}
+
+auto aggregate(std::vector<Event> const& events, bool gpu) -> std::vector<Scope_Stats>
+{
+    std::vector<Scope_Stats> stats{};
+    for (Event const& event : events)
+    {
+        if ((event.thread_id == gpu_thread_id) != gpu)
+            continue;
+        // Compare the names themselves: the same string literal can have different addresses in different translation units
+        auto it = std::find_if(stats.begin(), stats.end(), [&](Scope_Stats const& scope) {
+            return std::string_view{scope.name} == std::string_view{event.name};
+        });
+        if (it == stats.end())
+            it = stats.insert(stats.end(), Scope_Stats{.name = event.name});
+        uint64_t const duration = event.end_ns - event.begin_ns;
+        it->calls_count++;
+        it->total_ns += duration;
+        it->max_ns = std::max(it->max_ns, duration);
+    }
+    std::sort(stats.begin(), stats.end(), [](Scope_Stats const& a, Scope_Stats const& b) {
+        return a.total_ns > b.total_ns;
+    });
+    return stats;
+}
+
+auto find_record(uint64_t frame_index) -> FrameRecord*
+{
+    auto& history = state().history;
+    auto  it      = std::find_if(history.begin(), history.end(), [&](FrameRecord const& record) {
+        return record.profile.frame_index == frame_index;
+    });
+    return it != history.end() ? &*it : nullptr;
+}
+
+void complete(FrameRecord const& record)
+{
+    if (record.profile.frame_index >= state().latest_frame.frame_index)
+        state().latest_frame = record.profile;
+}
+
+/// Reads the timings of a frame in flight, which is old enough that the GPU is done with it, and frees its slot for the next frame
+void read_back(GpuFrame& gpu_frame)
+{
+    if (gpu_frame.scopes.empty())
+        return;
+
+    FrameRecord* const record = find_record(gpu_frame.frame_index);
+    for (GpuScopeQueries const& scope : gpu_frame.scopes)
+    {
+        if (!scope.has_ended || record == nullptr)
+            continue;
+        GLuint64 begin{};
+        GLuint64 end{};
+        glGetQueryObjectui64v(scope.begin_query, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(scope.end_query, GL_QUERY_RESULT, &end);
+        record->events.push_back({
+            .name      = scope.name,
+            .begin_ns  = static_cast<uint64_t>(static_cast<int64_t>(begin) + gpu_frame.gpu_to_cpu_offset_ns),
+            .end_ns    = static_cast<uint64_t>(static_cast<int64_t>(end) + gpu_frame.gpu_to_cpu_offset_ns),
+            .thread_id = gpu_thread_id,
+        });
+    }
+    gpu_frame.scopes.clear();
+    gpu_frame.used_queries_count = 0;
+
+    if (record != nullptr)
+    {
+        record->profile.gpu_scopes = aggregate(record->events, true);
+        record->is_waiting_for_gpu = false;
+        complete(*record);
+    }
+}
+
+void write_json_string(std::ofstream& file, std::string_view string)
+{
+    file << '"';
+    for (char const c : string)
+    {
+        if (c == '"' || c == '\\')
+            file << '\\';
+        file << c;
+    }
+    file << '"';
+}
+
+} // namespace
+
+void set_enabled(bool enabled)
+{
+    state().is_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+auto is_enabled() -> bool
+{
+    return state().is_enabled.load(std::memory_order_relaxed);
+}
+
+CpuScope::CpuScope(char const* name)
+    : _name{is_enabled() ? name : nullptr}
+{
+    if (_name != nullptr)
+        _begin_ns = now_ns();
+}
+
+CpuScope::~CpuScope()
+{
+    if (_name == nullptr)
+        return;
+    uint64_t const end_ns      = now_ns();
+    ThreadEvents&  thread      = thread_events();
+    uint64_t const write_index = thread.write_index.load(std::memory_order_relaxed);
+    thread.events[write_index & (events_per_thread - 1)].write(write_index, _name, _begin_ns, end_ns);
+    thread.write_index.store(write_index + 1, std::memory_order_release);
+}
+
+GpuScope::GpuScope(char const* name)
+{
+    if (!is_enabled())
+        return;
+    GpuFrame& gpu_frame = state().gpu_frames[state().frame_index % frames_in_flight];
+    if (gpu_frame.scopes.empty())
+    {
+        GLint64 gpu_now{};
+        glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+        gpu_frame.gpu_to_cpu_offset_ns = static_cast<int64_t>(now_ns()) - gpu_now;
+    }
+    gpu_frame.frame_index = state().frame_index;
+    // Timestamps instead of GL_TIME_ELAPSED queries, because those can't be nested
+    GpuScopeQueries scope{.name = name, .begin_query = gpu_frame.next_query()};
+    glQueryCounter(scope.begin_query, GL_TIMESTAMP);
+    _frame_index = state().frame_index;
+    _scope_index = gpu_frame.scopes.size();
+    gpu_frame.scopes.push_back(scope);
+}
+
+GpuScope::~GpuScope()
+{
+    if (_scope_index == static_cast<size_t>(-1))
+        return;
+    if (_frame_index != state().frame_index)
+        return; // The scope spans several frames, we ignore it
+    GpuFrame&        gpu_frame = state().gpu_frames[_frame_index % frames_in_flight];
+    GpuScopeQueries& scope     = gpu_frame.scopes[_scope_index];
+    scope.end_query            = gpu_frame.next_query();
+    scope.has_ended            = true;
+    glQueryCounter(scope.end_query, GL_TIMESTAMP);
+}
+
+void new_frame()
+{
+    auto&          s      = state();
+    uint64_t const end_ns = now_ns();
+
+    FrameRecord record{
+        .profile  = {.frame_index = s.frame_index, .duration_ns = end_ns - s.frame_begin_ns},
+        .begin_ns = s.frame_begin_ns,
+    };
+    {
+        std::scoped_lock lock{s.threads_mutex};
+        for (auto const& thread : s.threads)
+            drain(*thread, record.events);
+    }
+    record.profile.cpu_scopes = aggregate(record.events, false);
+    record.is_waiting_for_gpu = !s.gpu_frames[s.frame_index % frames_in_flight].scopes.empty();
+
+    if (is_enabled() || !record.events.empty() || record.is_waiting_for_gpu)
+    {
+        s.history.push_back(std::move(record));
+        if (s.history.size() > history_size)
+            s.history.pop_front();
+        if (!s.history.back().is_waiting_for_gpu)
+            complete(s.history.back());
+    }
+
+    s.frame_index++;
+    s.frame_begin_ns = end_ns;
+    // The slot of the new frame was last used `frames_in_flight` frames ago, so the GPU should be done with it
+    read_back(s.gpu_frames[s.frame_index % frames_in_flight]);
+}
+
+auto latest_frame() -> Frame_Profile const&
+{
+    return state().latest_frame;
+}
+
+void save_chrome_trace(std::filesystem::path const& path)
+{
+    auto file = std::ofstream{path};
+    if (!file)
+        handle_error(std::format("Failed to save the profiler trace to \"{}\"", path.string()));
+
+    // Timestamps are in microseconds
+    auto const write_event = [&](std::string_view name, uint32_t pid, uint32_t tid, uint64_t begin_ns, uint64_t end_ns) {
+        file << "{\"name\":";
+        write_json_string(file, name);
+        file << ",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+             << ",\"ts\":" << static_cast<double>(begin_ns) / 1000.
+             << ",\"dur\":" << static_cast<double>(end_ns - begin_ns) / 1000. << "},\n";
+    };
+
+    file.precision(15);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << R"({"name":"process_name","ph":"M","pid":0,"args":{"name":"Frames"}},)" << '\n';
+    file << R"({"name":"process_name","ph":"M","pid":1,"args":{"name":"CPU"}},)" << '\n';
+    file << R"({"name":"process_name","ph":"M","pid":2,"args":{"name":"GPU"}},)" << '\n';
+    for (FrameRecord const& record : state().history)
+    {
+        write_event(std::format("Frame {}", record.profile.frame_index), 0, 0, record.begin_ns, record.begin_ns + record.profile.duration_ns);
+        for (Event const& event : record.events)
+        {
+            if (event.thread_id == gpu_thread_id)
+                write_event(event.name, 2, 0, event.begin_ns, event.end_ns);
+            else
+                write_event(event.name, 1, event.thread_id, event.begin_ns, event.end_ns);
+        }
+    }
+    // A last metadata event, so that we don't end with a trailing comma, which JSON doesn't allow
+    file << R"({"name":"thread_name","ph":"M","pid":2,"tid":0,"args":{"name":"OpenGL"}})" << "\n]}\n";
+}
+
+} // namespace gl::profiler
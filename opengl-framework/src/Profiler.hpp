@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace gl::profiler {
+
+/// Disabled by default. When disabled, a scope costs a single atomic load.
+void set_enabled(bool);
+auto is_enabled() -> bool;
+
+/// Measures the time spent on the CPU until the end of the scope: `gl::profiler::CpuScope const scope{"Forces"};`
+/// Can be used from any thread, and nested. The name is not copied, so it must live as long as the profiler (typically a string literal).
+class CpuScope {
+public:
+    explicit CpuScope(char const* name);
+    ~CpuScope();
+    CpuScope(CpuScope const&)                    = delete;
+    auto operator=(CpuScope const&) -> CpuScope& = delete;
+    CpuScope(CpuScope&&)                         = delete;
+    auto operator=(CpuScope&&) -> CpuScope&      = delete;
+
+private:
+    char const* _name; // nullptr when the profiler was disabled
+    uint64_t    _begin_ns{};
+};
+
+/// Measures the time the GPU spends on the commands issued until the end of the scope: `gl::profiler::GpuScope const scope{"Draw particles"};`
+/// Must only be used on the thread that owns the OpenGL context. Can be nested.
+/// The timings are read back a few frames later, so that we never wait for the GPU.
+class GpuScope {
+public:
+    explicit GpuScope(char const* name);
+    ~GpuScope();
+    GpuScope(GpuScope const&)                    = delete;
+    auto operator=(GpuScope const&) -> GpuScope& = delete;
+    GpuScope(GpuScope&&)                         = delete;
+    auto operator=(GpuScope&&) -> GpuScope&      = delete;
+
+private:
+    uint64_t _frame_index{};
+    size_t   _scope_index{static_cast<size_t>(-1)}; // -1 when the profiler was disabled
+};
+
+/// All the scopes of a frame that have the same name
+struct Scope_Stats {
+    char const* name{};
+    uint32_t    calls_count{};
+    uint64_t    total_ns{}; // Including the nested scopes
+    uint64_t    max_ns{};
+};
+
+struct Frame_Profile {
+    uint64_t                 frame_index{};
+    uint64_t                 duration_ns{}; // On the CPU, between the two new_frame() that delimit the frame
+    std::vector<Scope_Stats> cpu_scopes{};  // Summed over all the threads. Sorted by total time, from the biggest.
+    std::vector<Scope_Stats> gpu_scopes{};  // Sorted by total time, from the biggest
+};
+
+/// Ends the current frame and starts the next one. gl::window_is_open() calls it for you: only call it yourself when you don't have a window (e.g. in a headless benchmark).
+void new_frame();
+/// The most recent frame whose GPU timings have been read back, which is a few frames behind the current one. Empty until then.
+auto latest_frame() -> Frame_Profile const&;
+/// Writes the last few hundred frames in the Chrome trace format. Open it in https://ui.perfetto.dev or chrome://tracing.
+void save_chrome_trace(std::filesystem::path const& path);
+
+} // namespace gl::profiler
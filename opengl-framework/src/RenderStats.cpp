@@ -0,0 +1,89 @@
+#include "RenderStats.hpp"
+#include <algorithm>
+
+namespace gl::render_stats {
+
+namespace {
+struct History {
+    std::array<Snapshot, rolling_window_size> frames{}; // Ring buffer
+    size_t                                    next_frame{0};
+    size_t                                    frames_count{0};
+    Snapshot                                  last_frame{};
+};
+
+auto history() -> History&
+{
+    static auto instance = History{};
+    return instance;
+}
+} // namespace
+
+auto name(Counter counter) -> std::string_view
+{
+    switch (counter)
+    {
+    case Counter::DrawCalls: return "Draw calls";
+    case Counter::ShaderBinds: return "Shader binds";
+    case Counter::UniformSets: return "Uniform sets";
+    case Counter::TextureBinds: return "Texture binds";
+    case Counter::TexturesCreated: return "Textures created";
+    case Counter::BufferUploads: return "Buffer uploads";
+    case Counter::UploadedBytes: return "Uploaded bytes";
+    case Counter::RenderTargetRenders: return "Render target renders";
+    default: return "Unknown";
+    }
+}
+
+void set_enabled(bool enabled)
+{
+    internal::is_enabled = enabled;
+}
+
+auto is_enabled() -> bool
+{
+    return internal::is_enabled;
+}
+
+void new_frame()
+{
+    if (!internal::is_enabled)
+        return;
+    auto& h                 = history();
+    h.last_frame            = internal::current_frame;
+    h.frames[h.next_frame]  = internal::current_frame;
+    h.next_frame            = (h.next_frame + 1) % rolling_window_size;
+    h.frames_count          = std::min(h.frames_count + 1, rolling_window_size);
+    internal::current_frame = Snapshot{};
+}
+
+auto last_frame() -> Snapshot const&
+{
+    return history().last_frame;
+}
+
+auto current_frame() -> Snapshot const&
+{
+    return internal::current_frame;
+}
+
+auto rolling_average(Counter counter) -> double
+{
+    auto const& h = history();
+    if (h.frames_count == 0)
+        return 0.;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < h.frames_count; ++i)
+        sum += h.frames[i][counter];
+    return static_cast<double>(sum) / static_cast<double>(h.frames_count);
+}
+
+auto rolling_max(Counter counter) -> uint64_t
+{
+    auto const& h   = history();
+    uint64_t    max = 0;
+    for (size_t i = 0; i < h.frames_count; ++i)
+        max = std::max(max, h.frames[i][counter]);
+    return max;
+}
+
+} // namespace gl::render_stats
@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace gl::render_stats {
+
+enum class Counter : uint8_t {
+    DrawCalls,           // Each glDraw*() call. A multi-draw counts as one.
+    ShaderBinds,         //
+    UniformSets,         //
+    TextureBinds,        // When setting a Texture as a uniform
+    TexturesCreated,     //
+    BufferUploads,       // Each glBufferData() / glBufferSubData() done by the meshes and buffer arenas
+    UploadedBytes,       //
+    RenderTargetRenders, //
+    COUNT,
+};
+static constexpr size_t counters_count = static_cast<size_t>(Counter::COUNT);
+
+auto name(Counter) -> std::string_view;
+
+/// The value of each counter, during one frame
+struct Snapshot {
+    std::array<uint64_t, counters_count> values{};
+
+    auto operator[](Counter counter) const -> uint64_t { return values[static_cast<size_t>(counter)]; }
+};
+
+namespace internal {
+inline bool     is_enabled{false};
+inline Snapshot current_frame{};
+} // namespace internal
+
+/// Must only be called from the thread that owns the OpenGL context. When the stats are disabled, it's just a branch.
+inline void count(Counter counter, uint64_t amount = 1)
+{
+    if (internal::is_enabled)
+        internal::current_frame.values[static_cast<size_t>(counter)] += amount;
+}
+
+inline void count_buffer_upload(size_t size_in_bytes)
+{
+    count(Counter::BufferUploads);
+    count(Counter::UploadedBytes, size_in_bytes);
+}
+
+/// Disabled by default
+void set_enabled(bool);
+auto is_enabled() -> bool;
+
+/// Stores the counters of the frame that ends, and resets them. gl::window_is_open() calls it for you.
+void new_frame();
+/// The counters of the previous frame
+auto last_frame() -> Snapshot const&;
+/// The counters of the frame in progress, so far
+auto current_frame() -> Snapshot const&;
+
+/// Number of frames over which the rolling statistics are computed (fewer when less frames have been recorded)
+static constexpr size_t rolling_window_size = 120;
+auto rolling_average(Counter) -> double;
+/// Compare it to the average to spot the frames that suddenly do way more work than the others
+auto rolling_max(Counter) -> uint64_t;
+
+} // namespace gl::render_stats
@@ -1,5 +1,6 @@
 #include "RenderTarget.hpp"
 #include <array>
+#include "RenderStats.hpp"
 #include "Texture.hpp"
 #include "handle_error.hpp"
 
@@ -97,6 +98,7 @@ RenderTarget::RenderTarget(RenderTarget_Descriptor const& desc)
 
 void RenderTarget::render(std::function<void()> const& render_fn)
 {
+    render_stats::count(render_stats::Counter::RenderTargetRenders);
     // Store previous state to restore it at the end
     int                previous_draw_framebuffer{};
     int                previous_read_framebuffer{};
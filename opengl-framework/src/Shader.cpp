@@ -1,6 +1,7 @@
 #include "Shader.hpp"
 #include <cassert>
 #include <fstream>
+#include "RenderStats.hpp"
 #include "Texture.hpp"
 #include "glm/gtc/type_ptr.hpp"
 #include "handle_error.hpp"
@@ -105,6 +106,20 @@ Shader::Shader(Shader_Descriptor const& desc)
     check_for_linking_errors(id());
 }
 
+ComputeShader::ComputeShader(ComputeShader_Descriptor const& desc)
+{
+    auto compute_shader = UniqueShaderModule{GL_COMPUTE_SHADER, desc.compute};
+    glAttachShader(id(), compute_shader.id());
+    glLinkProgram(id());
+    glDetachShader(id(), compute_shader.id());
+    check_for_linking_errors(id());
+}
+
+void ComputeShader::dispatch(GLuint groups_count_x, GLuint groups_count_y, GLuint groups_count_z) const
+{
+    glDispatchCompute(groups_count_x, groups_count_y, groups_count_z);
+}
+
 static void assert_shader_is_bound(GLuint id)
 {
 #ifndef NDEBUG
@@ -118,6 +133,7 @@ static void assert_shader_is_bound(GLuint id)
 
 void Shader::bind() const
 {
+    render_stats::count(render_stats::Counter::ShaderBinds);
     glUseProgram(id());
 }
 
@@ -140,6 +156,7 @@ auto Shader::uniform_location(std::string_view uniform_name) const -> GLint
 void Shader::set_uniform(std::string_view uniform_name, int v) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniform1i(uniform_location(uniform_name), v);
 }
 void Shader::set_uniform(std::string_view uniform_name, unsigned int v) const
@@ -153,51 +170,61 @@ void Shader::set_uniform(std::string_view uniform_name, bool v) const
 void Shader::set_uniform(std::string_view uniform_name, float v) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniform1f(uniform_location(uniform_name), v);
 }
 void Shader::set_uniform(std::string_view uniform_name, const glm::vec2& v) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniform2f(uniform_location(uniform_name), v.x, v.y);
 }
 void Shader::set_uniform(std::string_view uniform_name, const glm::vec3& v) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniform3f(uniform_location(uniform_name), v.x, v.y, v.z);
 }
 void Shader::set_uniform(std::string_view uniform_name, const glm::vec4& v) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniform4f(uniform_location(uniform_name), v.x, v.y, v.z, v.w);
 }
 void Shader::set_uniform(std::string_view uniform_name, const glm::uvec2& v) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniform2ui(uniform_location(uniform_name), v.x, v.y);
 }
 void Shader::set_uniform(std::string_view uniform_name, const glm::uvec3& v) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniform3ui(uniform_location(uniform_name), v.x, v.y, v.z);
 }
 void Shader::set_uniform(std::string_view uniform_name, const glm::uvec4& v) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniform4ui(uniform_location(uniform_name), v.x, v.y, v.z, v.w);
 }
 void Shader::set_uniform(std::string_view uniform_name, const glm::mat2& mat) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniformMatrix2fv(uniform_location(uniform_name), 1, GL_FALSE, glm::value_ptr(mat));
 }
 void Shader::set_uniform(std::string_view uniform_name, const glm::mat3& mat) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniformMatrix3fv(uniform_location(uniform_name), 1, GL_FALSE, glm::value_ptr(mat));
 }
 void Shader::set_uniform(std::string_view uniform_name, const glm::mat4& mat) const
 {
     assert_shader_is_bound(id());
+    render_stats::count(render_stats::Counter::UniformSets);
     glUniformMatrix4fv(uniform_location(uniform_name), 1, GL_FALSE, glm::value_ptr(mat));
 }
 
@@ -221,6 +248,7 @@ static auto get_next_texture_slot() -> GLuint
 
 void Shader::set_uniform(std::string_view uniform_name, Texture const& texture) const
 {
+    render_stats::count(render_stats::Counter::TextureBinds);
     auto const slot = get_next_texture_slot();
     glActiveTexture(GL_TEXTURE0 + slot);
     glBindTexture(GL_TEXTURE_2D, texture.id());
@@ -85,6 +85,9 @@ public:
     void set_uniform(std::string_view uniform_name, glm::mat4 const&) const;
     void set_uniform(std::string_view uniform_name, Texture const&) const;
 
+protected:
+    Shader() = default; // For the derived classes that attach their own shader modules
+
 private:
     auto uniform_location(std::string_view uniform_name) const -> GLint;
 
@@ -93,4 +96,19 @@ private:
     mutable std::unordered_map<std::string, GLint> _uniform_locations{};
 };
 
+struct ComputeShader_Descriptor {
+    AnyShaderSource compute{};
+};
+
+/// Requires OpenGL 4.3, which is not available on MacOS: check gl::supports_compute_shaders() before creating one.
+/// Uniforms are set just like for a Shader.
+class ComputeShader : public Shader {
+public:
+    explicit ComputeShader(ComputeShader_Descriptor const&);
+
+    /// Runs the shader on groups_count_x * groups_count_y * groups_count_z work groups. You must call bind() first.
+    /// Don't forget to call glMemoryBarrier() before using the data it wrote.
+    void dispatch(GLuint groups_count_x, GLuint groups_count_y = 1, GLuint groups_count_z = 1) const;
+};
+
 } // namespace gl
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "Texture.hpp"
 #include <cassert>
+#include "RenderStats.hpp"
 #include "glm/gtc/type_ptr.hpp"
 #include "img/img.hpp"
 #include "make_absolute_path.hpp"
@@ -24,6 +25,7 @@ static void upload_image_data(TextureSource::File const& source)
 
 Texture::Texture(AnyTextureSource const& source, TextureOptions const& options)
 {
+    render_stats::count(render_stats::Counter::TexturesCreated);
     glBindTexture(GL_TEXTURE_2D, _id.id());
     std::visit([&](auto&& source) { upload_image_data(source); }, source);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(options.minification_filter));
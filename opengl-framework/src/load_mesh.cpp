@@ -0,0 +1,418 @@
+#include "load_mesh.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h> // Before tinyobj_loader_opt.h, which includes it too
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "experimental/tinyobj_loader_opt.h"
+#include "glm/glm.hpp"
+#include "optimize_mesh.hpp"
+#include "handle_error.hpp"
+#include "make_absolute_path.hpp"
+#include "tiny_obj_loader.h"
+
+namespace {
+
+/// Read-only view of a whole file, mapped in memory. Empty if the file could not be opened.
+class MappedFile {
+public:
+    explicit MappedFile(std::filesystem::path const& path)
+    {
+#if defined(_WIN32)
+        _file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+            return;
+        _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (_mapping == nullptr)
+            return;
+        _data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (_data != nullptr)
+            _size = static_cast<size_t>(size.QuadPart);
+#else
+        _file = open(path.c_str(), O_RDONLY); // NOLINT(*vararg)
+        if (_file == -1)
+            return;
+        struct stat infos{};
+        if (fstat(_file, &infos) != 0 || infos.st_size == 0)
+            return;
+        void* const data = mmap(nullptr, static_cast<size_t>(infos.st_size), PROT_READ, MAP_PRIVATE, _file, 0);
+        if (data == MAP_FAILED) // NOLINT(*cstyle-cast, performance-no-int-to-ptr)
+            return;
+        _data = data;
+        _size = static_cast<size_t>(infos.st_size);
+#endif
+    }
+
+    ~MappedFile()
+    {
+#if defined(_WIN32)
+        if (_data != nullptr)
+            UnmapViewOfFile(_data);
+        if (_mapping != nullptr)
+            CloseHandle(_mapping);
+        if (_file != INVALID_HANDLE_VALUE)
+            CloseHandle(_file);
+#else
+        if (_data != nullptr)
+            munmap(const_cast<void*>(_data), _size); // NOLINT(*const-cast)
+        if (_file != -1)
+            close(_file);
+#endif
+    }
+
+    MappedFile(MappedFile const&)                    = delete;
+    auto operator=(MappedFile const&) -> MappedFile& = delete;
+    MappedFile(MappedFile&&)                         = delete;
+    auto operator=(MappedFile&&) -> MappedFile&      = delete;
+
+    auto bytes() const -> std::span<std::byte const> { return {static_cast<std::byte const*>(_data), _size}; }
+
+private:
+#if defined(_WIN32)
+    HANDLE _file{INVALID_HANDLE_VALUE};
+    HANDLE _mapping{nullptr};
+#else
+    int _file{-1};
+#endif
+    void const* _data{nullptr};
+    size_t      _size{0};
+};
+
+/// Must be incremented each time the content or layout of the cache changes, so that old caches get rebuilt
+constexpr uint32_t cache_version = 2;
+
+struct CacheHeader {
+    std::array<char, 4> magic{'G', 'L', 'M', 'C'};
+    uint32_t            version{cache_version};
+    uint64_t            source_size{};    // To detect that the source file changed
+    int64_t             source_time{};    //
+    uint32_t            is_optimized{};   // Loading with a different LoadMesh_Options::optimize rebuilds the cache
+    uint32_t            padding{};
+    uint64_t            vertices_count{}; // In floats
+    uint64_t            indices_count{};
+};
+
+auto cache_path(std::filesystem::path const& source_path) -> std::filesystem::path
+{
+    auto path = source_path;
+    path += ".meshcache";
+    return path;
+}
+
+auto make_cache_header(std::filesystem::path const& source_path, bool is_optimized) -> CacheHeader
+{
+    return CacheHeader{
+        .source_size  = static_cast<uint64_t>(std::filesystem::file_size(source_path)),
+        .source_time  = static_cast<int64_t>(std::filesystem::last_write_time(source_path).time_since_epoch().count()),
+        .is_optimized = is_optimized ? 1u : 0u,
+    };
+}
+
+struct CacheContent {
+    std::span<float const>    vertices;
+    std::span<uint32_t const> indices;
+};
+
+/// Points into the mapped file, so it's only valid as long as the file stays open.
+/// Returns nullopt if the cache is missing or outdated.
+auto read_cache(MappedFile const& file, std::filesystem::path const& source_path, bool is_optimized) -> std::optional<CacheContent>
+{
+    auto const bytes = file.bytes();
+    if (bytes.size() < sizeof(CacheHeader))
+        return std::nullopt;
+
+    CacheHeader header{};
+    std::memcpy(&header, bytes.data(), sizeof(CacheHeader));
+    CacheHeader const expected = make_cache_header(source_path, is_optimized);
+    if (header.magic != expected.magic
+        || header.version != expected.version
+        || header.source_size != expected.source_size
+        || header.source_time != expected.source_time
+        || header.is_optimized != expected.is_optimized
+        || bytes.size() != sizeof(CacheHeader) + header.vertices_count * sizeof(float) + header.indices_count * sizeof(uint32_t))
+    {
+        return std::nullopt;
+    }
+
+    // The mapping is page-aligned and the header is a multiple of 8 bytes, so the floats and indices are correctly aligned
+    static_assert(sizeof(CacheHeader) % 8 == 0);
+    auto const* const vertices = reinterpret_cast<float const*>(bytes.data() + sizeof(CacheHeader)); // NOLINT(*reinterpret-cast)
+    auto const* const indices  = reinterpret_cast<uint32_t const*>(vertices + header.vertices_count); // NOLINT(*reinterpret-cast)
+    return CacheContent{
+        .vertices = {vertices, header.vertices_count},
+        .indices  = {indices, header.indices_count},
+    };
+}
+
+/// Failing to write the cache is not an error (e.g. the folder is read-only): we will just parse the OBJ again next time
+void write_cache(std::filesystem::path const& source_path, gl::MeshData const& data, bool is_optimized)
+{
+    CacheHeader header    = make_cache_header(source_path, is_optimized);
+    header.vertices_count = data.vertices.size();
+    header.indices_count  = data.indices.size();
+
+    auto file = std::ofstream{cache_path(source_path), std::ios::binary};
+    if (!file)
+        return;
+    auto const write = [&](std::span<std::byte const> bytes) {
+        file.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size())); // NOLINT(*reinterpret-cast)
+    };
+    write(std::as_bytes(std::span{&header, 1}));
+    write(std::as_bytes(std::span{data.vertices}));
+    write(std::as_bytes(std::span{data.indices}));
+}
+
+/// A corner of a triangle, as indices in the position, normal and uv arrays of the OBJ. -1 when absent.
+struct Corner {
+    int position;
+    int normal;
+    int uv;
+
+    friend auto operator==(Corner const&, Corner const&) -> bool = default;
+};
+
+struct CornerHash {
+    auto operator()(Corner const& corner) const -> size_t
+    {
+        auto const hash = static_cast<uint64_t>(static_cast<uint32_t>(corner.position)) * 0x9E3779B97F4A7C15ull
+                          ^ static_cast<uint64_t>(static_cast<uint32_t>(corner.normal)) * 0xC2B2AE3D27D4EB4Full
+                          ^ static_cast<uint64_t>(static_cast<uint32_t>(corner.uv)) * 0x165667B19E3779F9ull;
+        return static_cast<size_t>(hash ^ (hash >> 29));
+    }
+};
+
+struct ObjContent {
+    std::vector<float>  positions{}; // 3 per position
+    std::vector<float>  normals{};   // 3 per normal
+    std::vector<float>  uvs{};       // 2 per uv
+    std::vector<Corner> corners{};   // 3 per triangle
+};
+
+auto parse_obj_classic(std::filesystem::path const& path) -> ObjContent
+{
+    tinyobj::ObjReaderConfig config{};
+    config.triangulate  = true;
+    config.vertex_color = false;
+    tinyobj::ObjReader reader{};
+    if (!reader.ParseFromFile(path.string(), config))
+        gl::handle_error(std::format("Failed to load mesh \"{}\":\n{}", path.string(), reader.Error()));
+
+    auto const& attrib = reader.GetAttrib();
+    ObjContent  content{
+        .positions = attrib.vertices,
+        .normals   = attrib.normals,
+        .uvs       = attrib.texcoords,
+    };
+    for (auto const& shape : reader.GetShapes())
+    {
+        for (auto const& index : shape.mesh.indices)
+            content.corners.push_back({.position = index.vertex_index, .normal = index.normal_index, .uv = index.texcoord_index});
+    }
+    return content;
+}
+
+/// Parses the file on several threads, straight from its memory mapping. Returns nothing if the parser doesn't handle the file.
+auto parse_obj_parallel(std::filesystem::path const& path, unsigned int threads_count) -> std::optional<ObjContent>
+{
+    MappedFile const file{path};
+    auto const       bytes = file.bytes();
+    if (bytes.empty())
+        return std::nullopt;
+
+    tinyobj_opt::attrib_t                attrib{};
+    std::vector<tinyobj_opt::shape_t>    shapes{};
+    std::vector<tinyobj_opt::material_t> materials{};
+    tinyobj_opt::LoadOption              option{};
+    option.req_num_threads = threads_count == 0 ? -1 : static_cast<int>(threads_count);
+    option.triangulate     = true;
+    if (!tinyobj_opt::parseObj(&attrib, &shapes, &materials, reinterpret_cast<char const*>(bytes.data()), bytes.size(), option)) // NOLINT(*reinterpret-cast)
+        return std::nullopt;
+    if (std::any_of(attrib.face_num_verts.begin(), attrib.face_num_verts.end(), [](int count) { return count != 3; }))
+        return std::nullopt;
+
+    ObjContent content{
+        .positions = {attrib.vertices.begin(), attrib.vertices.end()},
+        .normals   = {attrib.normals.begin(), attrib.normals.end()},
+        .uvs       = {attrib.texcoords.begin(), attrib.texcoords.end()},
+    };
+    // Missing indices come out of the parser as arbitrary negative values
+    auto const checked_index = [](int index, size_t values_count, size_t components_count) {
+        return index >= 0 && static_cast<size_t>(index) < values_count / components_count ? index : -1;
+    };
+    content.corners.reserve(attrib.indices.size());
+    for (auto const& index : attrib.indices)
+    {
+        int const position = checked_index(index.vertex_index, content.positions.size(), 3);
+        if (position == -1)
+            return std::nullopt;
+        content.corners.push_back({
+            .position = position,
+            .normal   = checked_index(index.normal_index, content.normals.size(), 3),
+            .uv       = checked_index(index.texcoord_index, content.uvs.size(), 2),
+        });
+    }
+    return content;
+}
+
+auto parse_obj(std::filesystem::path const& path, unsigned int threads_count) -> ObjContent
+{
+    if (threads_count != 1)
+    {
+        if (auto content = parse_obj_parallel(path, threads_count))
+            return std::move(*content);
+    }
+    return parse_obj_classic(path);
+}
+
+/// Merges the corners that reference the same position, normal and uv into a single vertex
+auto weld(ObjContent const& obj) -> gl::MeshData
+{
+    gl::MeshData data{};
+    data.indices.reserve(obj.corners.size());
+    data.vertices.reserve(obj.corners.size() * 8);
+
+    std::vector<bool> has_normal{};
+    has_normal.reserve(obj.corners.size());
+
+    std::unordered_map<Corner, uint32_t, CornerHash> vertex_of_corner{};
+    vertex_of_corner.reserve(obj.corners.size());
+    for (Corner const& corner : obj.corners)
+    {
+        auto const [it, is_new] = vertex_of_corner.try_emplace(corner, static_cast<uint32_t>(has_normal.size()));
+        data.indices.push_back(it->second);
+        if (!is_new)
+            continue;
+
+        auto const p = static_cast<size_t>(corner.position) * 3;
+        data.vertices.insert(data.vertices.end(), {obj.positions[p], obj.positions[p + 1], obj.positions[p + 2]});
+        if (corner.normal >= 0)
+        {
+            auto const n = static_cast<size_t>(corner.normal) * 3;
+            data.vertices.insert(data.vertices.end(), {obj.normals[n], obj.normals[n + 1], obj.normals[n + 2]});
+        }
+        else
+        {
+            data.vertices.insert(data.vertices.end(), {0.f, 0.f, 0.f});
+        }
+        if (corner.uv >= 0)
+        {
+            auto const uv = static_cast<size_t>(corner.uv) * 2;
+            data.vertices.insert(data.vertices.end(), {obj.uvs[uv], obj.uvs[uv + 1]});
+        }
+        else
+        {
+            data.vertices.insert(data.vertices.end(), {0.f, 0.f});
+        }
+        has_normal.push_back(corner.normal >= 0);
+    }
+
+    // Smooth normals for the vertices that have none: the sum of the normals of the triangles around them, weighted by their area
+    if (std::find(has_normal.begin(), has_normal.end(), false) == has_normal.end())
+        return data;
+    auto const position = [&](uint32_t vertex) {
+        return glm::vec3{data.vertices[vertex * 8], data.vertices[vertex * 8 + 1], data.vertices[vertex * 8 + 2]};
+    };
+    for (size_t i = 0; i + 2 < data.indices.size(); i += 3)
+    {
+        glm::vec3 const a      = position(data.indices[i]);
+        glm::vec3 const normal = glm::cross(position(data.indices[i + 1]) - a, position(data.indices[i + 2]) - a);
+        for (size_t k = 0; k < 3; ++k)
+        {
+            uint32_t const vertex = data.indices[i + k];
+            if (has_normal[vertex])
+                continue;
+            for (uint32_t axis = 0; axis < 3; ++axis)
+                data.vertices[vertex * 8 + 3 + axis] += normal[static_cast<glm::length_t>(axis)];
+        }
+    }
+    for (uint32_t vertex = 0; vertex < has_normal.size(); ++vertex)
+    {
+        if (has_normal[vertex])
+            continue;
+        glm::vec3 const normal = glm::vec3{data.vertices[vertex * 8 + 3], data.vertices[vertex * 8 + 4], data.vertices[vertex * 8 + 5]};
+        float const     length = glm::length(normal);
+        for (uint32_t axis = 0; axis < 3; ++axis)
+            data.vertices[vertex * 8 + 3 + axis] = length > 0.f ? normal[static_cast<glm::length_t>(axis)] / length : 0.f;
+    }
+    return data;
+}
+
+} // namespace
+
+namespace gl {
+
+auto mesh_data_layout() -> std::vector<AnyVertexAttribute> const&
+{
+    static auto const layout = std::vector<AnyVertexAttribute>{VertexAttribute::Position3D{0}, VertexAttribute::Normal3D{1}, VertexAttribute::UV{2}};
+    return layout;
+}
+
+static auto make_mesh(std::span<float const> vertices, std::span<uint32_t const> indices) -> Mesh
+{
+    return Mesh{{
+        .vertex_buffers = {{
+            .layout = mesh_data_layout(),
+            .data   = vertices,
+        }},
+        .index_buffer   = indices,
+    }};
+}
+
+auto load_mesh_data(std::filesystem::path const& path, LoadMesh_Options const& options) -> MeshData
+{
+    auto const absolute_path = make_absolute_path(path);
+    if (options.use_cache)
+    {
+        MappedFile const cache{cache_path(absolute_path)};
+        if (auto const content = read_cache(cache, absolute_path, options.optimize))
+        {
+            return MeshData{
+                .vertices = {content->vertices.begin(), content->vertices.end()},
+                .indices  = {content->indices.begin(), content->indices.end()},
+            };
+        }
+    }
+
+    auto data = weld(parse_obj(absolute_path, options.threads_count));
+    if (options.optimize)
+    {
+        auto const report = optimize_mesh(data);
+        if (options.optimization_report != nullptr)
+            *options.optimization_report = report;
+    }
+    if (options.use_cache)
+        write_cache(absolute_path, data, options.optimize);
+    return data;
+}
+
+auto load_mesh(std::filesystem::path const& path, LoadMesh_Options const& options) -> Mesh
+{
+    // Uploads straight from the mapped cache file, without copying it into a MeshData first
+    if (options.use_cache)
+    {
+        auto const       absolute_path = make_absolute_path(path);
+        MappedFile const cache{cache_path(absolute_path)};
+        if (auto const content = read_cache(cache, absolute_path, options.optimize))
+            return make_mesh(content->vertices, content->indices);
+    }
+
+    auto const data = load_mesh_data(path, options);
+    return make_mesh(data.vertices, data.indices);
+}
+
+} // namespace gl
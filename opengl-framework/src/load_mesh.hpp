@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include "Mesh.hpp"
+
+namespace gl {
+
+/// Vertices ready to be uploaded to the GPU, with the layout returned by mesh_data_layout()
+struct MeshData {
+    static constexpr size_t floats_per_vertex = 8;
+
+    std::vector<float>    vertices{}; // Interleaved position (3 floats), normal (3 floats) and uv (2 floats)
+    std::vector<uint32_t> indices{};  // 3 per triangle
+};
+
+struct MeshOptimization_Report; // In optimize_mesh.hpp
+
+/// Position3D at location 0, Normal3D at location 1 and UV at location 2
+auto mesh_data_layout() -> std::vector<AnyVertexAttribute> const&;
+
+struct LoadMesh_Options {
+    /// Whether to read and write a binary cache next to the source file (e.g. "bunny.obj.meshcache").
+    /// The cache is rebuilt automatically when the source file changes.
+    bool use_cache{true};
+    /// Number of threads used to parse the OBJ: 0 uses all the hardware threads (up to 32), 1 uses the classic single-threaded parser.
+    /// The multithreaded parser falls back to the classic one on files it can't handle.
+    unsigned int threads_count{0};
+    /// Reorders the triangles and vertices for the GPU caches (see optimize_mesh()). Done once, before writing the cache.
+    bool optimize{true};
+    /// When set, receives the ACMR before and after the optimization. Left untouched when the mesh comes from the cache, which was optimized before being written.
+    MeshOptimization_Report* optimization_report{nullptr};
+};
+
+/// Loads an OBJ file, triangulated, with identical vertices merged so that each one is only stored once.
+/// Vertices that have no normal in the file get a smooth normal computed from the faces around them.
+auto load_mesh_data(std::filesystem::path const& path, LoadMesh_Options const& options = {}) -> MeshData;
+/// Loads an OBJ file straight into a Mesh. See load_mesh_data().
+auto load_mesh(std::filesystem::path const& path, LoadMesh_Options const& options = {}) -> Mesh;
+
+} // namespace gl
@@ -6,6 +6,8 @@
 #include <vector>
 #include "Camera.hpp"
 #include "GLFW/glfw3.h"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
 #include "Shader.hpp"
 #include "glfw.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -144,13 +146,17 @@ void window_resized_callback(GLFWwindow*, int width_in_screen_coordinates, int h
 
 namespace gl {
 
-void init(std::string_view window_title)
+static void init_impl(std::string_view window_title, bool headless)
 {
     assert(context().window == nullptr && "You are calling gl::init() twice. You must only call it once.");
 
     glfwSetErrorCallback([](int, const char* error_message) {
         handle_error(std::format("[glfw error] {}", error_message));
     });
+#if defined(__linux__)
+    if (headless)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL); // Doesn't need an X11 or Wayland server
+#endif
     if (!glfwInit())
         handle_error("[opengl_framework] Failed to initialize glfw");
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -164,6 +170,13 @@ void init(std::string_view window_title)
 #endif
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // Required on MacOS
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);           // Required on MacOS
+    if (headless)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#if defined(__linux__)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API); // The null platform only creates contexts with EGL (or OSMesa)
+#endif
+    }
     context().window = glfwCreateWindow(1280, 720, window_title.data(), nullptr, nullptr);
     if (!context().window)
         handle_error("[opengl_framework] Failed to create the window");
@@ -193,6 +206,16 @@ void init(std::string_view window_title)
     glfwSetFramebufferSizeCallback(context().window, &framebuffer_resized_callback);
 }
 
+void init(std::string_view window_title)
+{
+    init_impl(window_title, false);
+}
+
+void init_headless()
+{
+    init_impl("", true);
+}
+
 void maximize_window()
 {
     assert_init_has_been_called();
@@ -215,6 +238,8 @@ auto window_is_open() -> bool
 
     glfwSwapBuffers(context().window);
     glfwPollEvents();
+    profiler::new_frame();
+    render_stats::new_frame();
     context().is_first_frame = false;
     return !glfwWindowShouldClose(context().window);
 }
@@ -282,6 +307,12 @@ auto mouse_position() -> glm::vec2
     };
 }
 
+auto supports_compute_shaders() -> bool
+{
+    assert_init_has_been_called();
+    return GLAD_GL_VERSION_4_3 != 0;
+}
+
 static auto default_shader() -> Shader&
 {
     static auto instance = Shader{{
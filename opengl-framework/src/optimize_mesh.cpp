@@ -0,0 +1,216 @@
+#include "optimize_mesh.hpp"
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include "glm/glm.hpp"
+
+namespace gl {
+
+auto average_cache_miss_ratio(std::span<uint32_t const> indices, size_t vertices_count, size_t cache_size) -> float
+{
+    if (indices.empty())
+        return 0.f;
+    // FIFO cache: a vertex is in the cache if fewer than cache_size vertices entered it after it
+    std::vector<size_t> entry_time(vertices_count, 0); // 0 means never entered
+    size_t              misses_count{0};
+    for (uint32_t const vertex : indices)
+    {
+        if (entry_time[vertex] != 0 && misses_count - entry_time[vertex] < cache_size)
+            continue;
+        ++misses_count;
+        entry_time[vertex] = misses_count;
+    }
+    return static_cast<float>(misses_count) / static_cast<float>(indices.size() / 3);
+}
+
+auto optimize_vertex_cache(std::span<uint32_t> indices, size_t vertices_count, size_t cache_size) -> std::vector<size_t>
+{
+    assert(indices.size() % 3 == 0);
+    size_t const triangles_count = indices.size() / 3;
+
+    // Triangles around each vertex, stored contiguously
+    std::vector<uint32_t> live_triangles_count(vertices_count, 0);
+    for (uint32_t const vertex : indices)
+        ++live_triangles_count[vertex];
+    std::vector<size_t> adjacency_offsets(vertices_count + 1, 0);
+    std::inclusive_scan(live_triangles_count.begin(), live_triangles_count.end(), adjacency_offsets.begin() + 1, std::plus<>{}, size_t{0});
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<size_t> cursors(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<size_t>   cache_time(vertices_count, 0);
+    std::vector<uint8_t>  is_emitted(triangles_count, 0);
+    std::vector<uint32_t> dead_ends{};  // Recently used vertices, to continue from when we reach a vertex with no triangle left
+    std::vector<uint32_t> candidates{}; // Vertices of the triangles emitted around the current fanning vertex
+    std::vector<uint32_t> output{};
+    std::vector<size_t>   clusters{};
+    output.reserve(indices.size());
+    dead_ends.reserve(indices.size());
+    size_t time{cache_size + 1};
+    size_t next_unvisited_vertex{0};
+
+    auto const skip_dead_end = [&]() -> int64_t {
+        while (!dead_ends.empty())
+        {
+            uint32_t const vertex = dead_ends.back();
+            dead_ends.pop_back();
+            if (live_triangles_count[vertex] > 0)
+                return vertex;
+        }
+        for (; next_unvisited_vertex < vertices_count; ++next_unvisited_vertex)
+        {
+            if (live_triangles_count[next_unvisited_vertex] > 0)
+                return static_cast<int64_t>(next_unvisited_vertex);
+        }
+        return -1;
+    };
+
+    int64_t fanning_vertex = skip_dead_end();
+    if (fanning_vertex >= 0)
+        clusters.push_back(0);
+    while (fanning_vertex >= 0)
+    {
+        auto const fan = static_cast<size_t>(fanning_vertex);
+        candidates.clear();
+        for (size_t a = adjacency_offsets[fan]; a < adjacency_offsets[fan + 1]; ++a)
+        {
+            uint32_t const triangle = adjacency[a];
+            if (is_emitted[triangle])
+                continue;
+            for (size_t k = 0; k < 3; ++k)
+            {
+                uint32_t const vertex = indices[triangle * 3 + k];
+                output.push_back(vertex);
+                dead_ends.push_back(vertex);
+                candidates.push_back(vertex);
+                --live_triangles_count[vertex];
+                if (time - cache_time[vertex] > cache_size)
+                    cache_time[vertex] = time++;
+            }
+            is_emitted[triangle] = 1;
+        }
+
+        // Continue with the candidate that has been in the cache for the longest time, as long as it will still be in the cache once all its triangles are emitted
+        fanning_vertex = -1;
+        size_t best_priority{0};
+        for (uint32_t const vertex : candidates)
+        {
+            if (live_triangles_count[vertex] == 0)
+                continue;
+            size_t const priority = time - cache_time[vertex] + 2 * live_triangles_count[vertex] <= cache_size
+                                        ? time - cache_time[vertex]
+                                        : 0;
+            if (priority > best_priority)
+            {
+                best_priority  = priority;
+                fanning_vertex = vertex;
+            }
+        }
+        if (fanning_vertex == -1)
+        {
+            fanning_vertex = skip_dead_end();
+            if (fanning_vertex >= 0)
+                clusters.push_back(output.size() / 3);
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+    return clusters;
+}
+
+void optimize_overdraw(std::span<uint32_t> indices, std::span<float const> positions, size_t floats_per_vertex, std::span<size_t const> clusters)
+{
+    size_t const triangles_count = indices.size() / 3;
+    auto const   position        = [&](uint32_t vertex) {
+        return glm::vec3{positions[vertex * floats_per_vertex], positions[vertex * floats_per_vertex + 1], positions[vertex * floats_per_vertex + 2]};
+    };
+
+    struct Cluster {
+        size_t    begin{}; // In triangles
+        size_t    end{};   //
+        glm::vec3 centroid{};
+        glm::vec3 normal{};
+        float     sort_key{};
+    };
+    std::vector<Cluster> infos(clusters.size());
+    glm::vec3            mesh_centroid{0.f};
+    float                mesh_area{0.f};
+    for (size_t c = 0; c < clusters.size(); ++c)
+    {
+        Cluster& cluster = infos[c];
+        cluster.begin    = clusters[c];
+        cluster.end      = c + 1 < clusters.size() ? clusters[c + 1] : triangles_count;
+        float area{0.f};
+        for (size_t t = cluster.begin; t < cluster.end; ++t)
+        {
+            glm::vec3 const p0     = position(indices[t * 3]);
+            glm::vec3 const p1     = position(indices[t * 3 + 1]);
+            glm::vec3 const p2     = position(indices[t * 3 + 2]);
+            glm::vec3 const normal = glm::cross(p1 - p0, p2 - p0); // Its length is twice the area of the triangle
+            float const     weight = glm::length(normal);
+            cluster.normal += normal;
+            cluster.centroid += weight * (p0 + p1 + p2) / 3.f;
+            area += weight;
+        }
+        mesh_centroid += cluster.centroid;
+        mesh_area += area;
+        cluster.centroid = area > 0.f ? cluster.centroid / area : position(indices[cluster.begin * 3]);
+    }
+    if (mesh_area > 0.f)
+        mesh_centroid /= mesh_area;
+
+    // Clusters on the outside of the mesh and facing away from its center occlude the others: draw them first
+    for (Cluster& cluster : infos)
+    {
+        float const length = glm::length(cluster.normal);
+        cluster.sort_key   = length > 0.f ? glm::dot(cluster.centroid - mesh_centroid, cluster.normal / length) : 0.f;
+    }
+    std::stable_sort(infos.begin(), infos.end(), [](Cluster const& a, Cluster const& b) {
+        return a.sort_key > b.sort_key;
+    });
+
+    std::vector<uint32_t> sorted{};
+    sorted.reserve(indices.size());
+    for (Cluster const& cluster : infos)
+        sorted.insert(sorted.end(), indices.begin() + static_cast<std::ptrdiff_t>(cluster.begin * 3), indices.begin() + static_cast<std::ptrdiff_t>(cluster.end * 3));
+    std::copy(sorted.begin(), sorted.end(), indices.begin());
+}
+
+void optimize_vertex_fetch(std::span<uint32_t> indices, std::vector<float>& vertices, size_t floats_per_vertex)
+{
+    constexpr uint32_t    unassigned = ~uint32_t{0};
+    std::vector<uint32_t> new_index(vertices.size() / floats_per_vertex, unassigned);
+    std::vector<float>    new_vertices{};
+    new_vertices.reserve(vertices.size());
+    for (uint32_t& index : indices)
+    {
+        if (new_index[index] == unassigned)
+        {
+            new_index[index] = static_cast<uint32_t>(new_vertices.size() / floats_per_vertex);
+            auto const first = vertices.begin() + static_cast<std::ptrdiff_t>(index * floats_per_vertex);
+            new_vertices.insert(new_vertices.end(), first, first + static_cast<std::ptrdiff_t>(floats_per_vertex));
+        }
+        index = new_index[index];
+    }
+    vertices = std::move(new_vertices); // Vertices that no triangle uses are dropped
+}
+
+auto optimize_mesh(MeshData& data, OptimizeMesh_Options const& options) -> MeshOptimization_Report
+{
+    size_t const            vertices_count = data.vertices.size() / MeshData::floats_per_vertex;
+    MeshOptimization_Report report{};
+    report.acmr_before = average_cache_miss_ratio(data.indices, vertices_count, options.cache_size);
+
+    auto const clusters = optimize_vertex_cache(data.indices, vertices_count, options.cache_size);
+    if (options.sort_for_overdraw)
+        optimize_overdraw(data.indices, data.vertices, MeshData::floats_per_vertex, clusters);
+    optimize_vertex_fetch(data.indices, data.vertices, MeshData::floats_per_vertex);
+
+    report.acmr_after = average_cache_miss_ratio(data.indices, data.vertices.size() / MeshData::floats_per_vertex, options.cache_size);
+    return report;
+}
+
+} // namespace gl
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "load_mesh.hpp"
+
+namespace gl {
+
+struct OptimizeMesh_Options {
+    /// Size of the post-transform vertex cache that we optimize for. 16 is a good fit for most GPUs.
+    size_t cache_size{16};
+    /// Also sorts groups of triangles so that the ones facing outwards are drawn first, which reduces overdraw.
+    /// Costs a little bit of vertex cache efficiency.
+    bool sort_for_overdraw{false};
+};
+
+/// Average Cache Miss Ratio: number of vertices transformed per triangle, with a FIFO cache of the given size.
+/// 3 is the worst, ~0.5 the best possible for a regular mesh.
+struct MeshOptimization_Report {
+    float acmr_before{};
+    float acmr_after{};
+};
+
+/// Reorders the triangles for the vertex cache (Tipsify), optionally sorts them to reduce overdraw, then reorders the vertices in the order in which they are first used, for the vertex fetch cache.
+/// The mesh looks exactly the same afterwards, it's only faster to draw.
+auto optimize_mesh(MeshData& data, OptimizeMesh_Options const& options = {}) -> MeshOptimization_Report;
+
+/// Reorders the triangles so that vertices are reused while they are still in the post-transform cache.
+/// "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", Sander, Nehab and Barczak, 2007.
+/// Returns the index of the first triangle of each cluster: the places where the algorithm had to jump somewhere else in the mesh. Groups of triangles between two of them can be reordered without hurting the cache much.
+auto optimize_vertex_cache(std::span<uint32_t> indices, size_t vertices_count, size_t cache_size = 16) -> std::vector<size_t>;
+/// Reorders the clusters returned by optimize_vertex_cache() so that the ones on the outside of the mesh, facing outwards, come first
+void optimize_overdraw(std::span<uint32_t> indices, std::span<float const> positions, size_t floats_per_vertex, std::span<size_t const> clusters);
+/// Renumbers the vertices in the order in which they are first referenced by the indices, and reorders the vertex data accordingly
+void optimize_vertex_fetch(std::span<uint32_t> indices, std::vector<float>& vertices, size_t floats_per_vertex);
+
+auto average_cache_miss_ratio(std::span<uint32_t const> indices, size_t vertices_count, size_t cache_size = 16) -> float;
+
+} // namespace gl
@@ -0,0 +1,2 @@
+#define TINYOBJ_LOADER_OPT_IMPLEMENTATION
+#include "experimental/tinyobj_loader_opt.h"
@@ -0,0 +1,74 @@
+#include "gpu_check.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include "Curve.hpp"
+#include "GpuParticleSystem.hpp"
+#include "ParticlePool.hpp"
+#include "rng.hpp"
+#include "simulation.hpp"
+
+/// The GPU doesn't round exactly like the CPU (fused multiply-adds, different order of operations).
+/// The finite difference in the closest point search amplifies these differences in the velocities.
+static constexpr float position_tolerance = 1e-5f;
+static constexpr float velocity_tolerance = 5e-4f;
+
+auto check_gpu_simulation(size_t particles_count, size_t steps_count, float dt, uint64_t seed) -> bool
+{
+    ParticlePool cpu_particles{particles_count};
+    cpu_particles.spawn(particles_count);
+    rng::Generator generator{seed};
+    generator.fill(cpu_particles.x(), -1.f, 1.f);
+    generator.fill(cpu_particles.y(), -1.f, 1.f);
+    generator.fill(cpu_particles.vx(), -0.1f, 0.1f);
+    generator.fill(cpu_particles.vy(), -0.1f, 0.1f);
+    generator.fill(cpu_particles.mass(), 1.f, 2.f);
+    std::fill(cpu_particles.lifespan().begin(), cpu_particles.lifespan().end(), 1e6f); // So that the two pools can be compared particle by particle
+
+    // As many slots as particles: each spawn() overwrites all of them, starting from the first one, so read_back() gives the particles in the same order as the pool
+    GpuParticleSystem gpu_particles{particles_count};
+    ParticlePool      read_back_particles{particles_count};
+
+    std::array<glm::vec2, 4> const control_points{{{-0.6f, -0.6f}, {-0.2f, 0.5f}, {0.3f, -0.4f}, {0.8f, 0.5f}}};
+    Curve const                    curve{{.kind = CurveKind::Bezier, .control_points = {control_points.begin(), control_points.end()}}};
+    simulation::Parameters const   params{.forces = {.gravity = {0.f, -0.5f}, .air_friction = 0.3f}}; // All the terms of the force model
+    simulation::Scratch            scratch{};
+
+    float  max_difference          = 0.f;
+    float  max_velocity_difference = 0.f;
+    float  max_age_difference      = 0.f; // Must be 0: both add the same dt to the same value
+    size_t worst_step              = 0;
+    for (size_t step = 0; step < steps_count; ++step)
+    {
+        // Both start each step from the same particles. Otherwise the rounding differences pile up, and the closest point search is chaotic enough
+        // that after a few hundred steps some particles end up attracted by another part of the curve, even though both implementations are correct.
+        gpu_particles.spawn(cpu_particles);
+        gpu_particles.update(dt, params.forces, control_points);
+        simulation::step(cpu_particles, curve, params, dt, scratch);
+        gpu_particles.read_back(read_back_particles);
+        if (read_back_particles.size() != cpu_particles.size())
+        {
+            std::cerr << "GPU check failed at step " << step << ": " << read_back_particles.size() << " particles alive on the GPU, " << cpu_particles.size() << " on the CPU\n";
+            return false;
+        }
+
+        for (size_t i = 0; i < cpu_particles.size(); ++i)
+        {
+            float const difference = std::max(std::abs(cpu_particles.x()[i] - read_back_particles.x()[i]), std::abs(cpu_particles.y()[i] - read_back_particles.y()[i]));
+            if (difference > max_difference)
+            {
+                max_difference = difference;
+                worst_step     = step;
+            }
+            max_velocity_difference = std::max({max_velocity_difference, std::abs(cpu_particles.vx()[i] - read_back_particles.vx()[i]), std::abs(cpu_particles.vy()[i] - read_back_particles.vy()[i])});
+            max_age_difference      = std::max(max_age_difference, std::abs(cpu_particles.age()[i] - read_back_particles.age()[i]));
+        }
+    }
+
+    bool const success = max_difference <= position_tolerance && max_velocity_difference <= velocity_tolerance && max_age_difference == 0.f;
+    std::cout << "GPU check (" << particles_count << " particles, " << steps_count << " steps): max position difference after a step " << max_difference
+              << " (at step " << worst_step << "), max velocity difference " << max_velocity_difference << ", max age difference " << max_age_difference
+              << (success ? ", OK\n" : ", FAILED\n");
+    return success;
+}
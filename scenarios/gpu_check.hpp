@@ -0,0 +1,7 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/// Moves the same particles with GpuParticleSystem and with simulation::step(), then compares them.
+/// Needs an OpenGL 4.3 context, e.g. from gl::init_headless(). Prints the biggest difference, and returns false if it is above the tolerance.
+auto check_gpu_simulation(size_t particles_count, size_t steps_count, float dt, uint64_t seed) -> bool;
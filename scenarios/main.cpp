@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "GpuParticleSystem.hpp"
+#include "Scene.hpp"
+#include "gpu_check.hpp"
+#include "opengl-framework/opengl-framework.hpp"
+#include "peak_memory.hpp"
+#include "recording.hpp"
+#include "rng.hpp"
+
+// Runs scripted versions of the scene of the app for a fixed number of steps, without a window, and reports how fast they run.
+// With the same seed and the same dt, a scenario always computes exactly the same thing (on the same machine and build).
+// It can also replay a session recorded by the app, and fast-forward to a snapshot to measure what happens after a long run without waiting for it.
+
+enum class CurveMotion {
+    Still,  // The mouse never moves
+    Circle, // The mouse goes round in circles, so the curve changes every step
+};
+
+struct Scenario {
+    std::string      name;
+    Scene_Descriptor scene;
+    /// Scripted instead of the mouse. `time` is in seconds since the start of the scenario.
+    std::function<SceneInput(float time)> input;
+};
+
+struct Scenario_Descriptor {
+    size_t      particles_count{1000}; // Spawned at the start, then kept roughly constant by the emitter
+    size_t      obstacles_count{0};    // Random segments the particles bounce on
+    CurveMotion curve_motion{CurveMotion::Circle};
+    bool        mutual_attraction{false};
+};
+
+static auto make_scenario(std::string name, Scenario_Descriptor const& desc, uint64_t seed) -> Scenario
+{
+    Scene_Descriptor scene{};
+    float const      mean_lifespan = (scene.lifespan.min + scene.lifespan.max) / 2.f;
+    scene.capacity                     = desc.particles_count * 2; // Leaves room for the fluctuations of the emission
+    scene.initial_particles            = desc.particles_count;
+    scene.emission_rate                = static_cast<float>(desc.particles_count) / mean_lifespan;
+    scene.simulation.mutual_attraction = desc.mutual_attraction;
+
+    rng::Generator generator{seed, 1}; // Not the stream of the scene, so that adding obstacles doesn't change where the particles spawn
+    for (size_t i = 0; i < desc.obstacles_count; ++i)
+    {
+        scene.obstacles.push_back({
+            .A = {generator.uniform(-1.f, 1.f), generator.uniform(-1.f, 1.f)},
+            .B = {generator.uniform(-1.f, 1.f), generator.uniform(-1.f, 1.f)},
+        });
+    }
+
+    auto input = [motion = desc.curve_motion](float time) -> SceneInput {
+        if (motion == CurveMotion::Still)
+            return {.mouse_position = {0.3f, -0.4f}};
+        return {.mouse_position = 0.5f * glm::vec2{std::cos(time), std::sin(time)}};
+    };
+    return {.name = std::move(name), .scene = std::move(scene), .input = input};
+}
+
+static auto all_scenarios(uint64_t seed) -> std::vector<Scenario>
+{
+    return {
+        make_scenario("still curve/1k", {.particles_count = 1'000, .curve_motion = CurveMotion::Still}, seed),
+        make_scenario("moving curve/1k", {.particles_count = 1'000}, seed),
+        make_scenario("moving curve/10k", {.particles_count = 10'000}, seed),
+        make_scenario("moving curve/50k", {.particles_count = 50'000}, seed),
+        make_scenario("obstacles 16/10k", {.particles_count = 10'000, .obstacles_count = 16}, seed),
+        make_scenario("obstacles 128/10k", {.particles_count = 10'000, .obstacles_count = 128}, seed),
+        make_scenario("mutual attraction/10k", {.particles_count = 10'000, .mutual_attraction = true}, seed),
+    };
+}
+
+struct Options {
+    std::string           filter{};
+    size_t                steps_count{600};
+    float                 dt{1.f / 60.f};
+    uint64_t              seed{42};
+    std::filesystem::path replay{};        // Inputs recorded by the app. Replaces the scenarios.
+    std::filesystem::path load_snapshot{}; // Starts from this snapshot instead of from step 0
+    std::filesystem::path save_snapshot{}; // Of the state at the end of the run
+    bool                  check_gpu{false};  // Compares GpuParticleSystem to the CPU simulation instead of running the scenarios
+};
+
+/// FNV-1a of all the attributes of the particles: two runs that end with the same checksum computed exactly the same thing
+static auto checksum(ParticlePool const& particles) -> uint64_t
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t attr = 0; attr < static_cast<size_t>(ParticleAttribute::COUNT); ++attr)
+    {
+        for (std::byte const byte : std::as_bytes(particles.attribute(static_cast<ParticleAttribute>(attr))))
+            hash = (hash ^ static_cast<uint64_t>(byte)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+static void print_header()
+{
+    std::cout << std::left << std::setw(28) << "Scenario" << std::right << std::setw(16) << "Steps" << std::setw(12) << "Particles" << std::setw(14) << "Steps / s"
+              << std::setw(22) << "ns / particle / step" << std::setw(20) << "Peak memory (MB)" << std::setw(20) << "Checksum" << '\n';
+}
+
+/// Runs the steps [scene.steps_count(), end_step) and prints a line of results
+static void run(std::string_view name, Scene& scene, uint64_t end_step, std::function<SceneRecording::Step(uint64_t step)> const& input, Options const& options)
+{
+    uint64_t const first_step = scene.steps_count();
+
+    uint64_t   particle_steps = 0;
+    auto const begin          = std::chrono::steady_clock::now();
+    while (scene.steps_count() < end_step)
+    {
+        particle_steps += scene.particles().size();
+        SceneRecording::Step const step = input(scene.steps_count());
+        scene.step(step.input, step.dt);
+    }
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    if (!options.save_snapshot.empty())
+        save_snapshot(scene.snapshot(), options.save_snapshot);
+
+    // The peak is the one of the whole process, so it never goes down from one scenario to the next. Use --filter to measure a scenario alone.
+    std::cout << std::left << std::setw(28) << name
+              << std::right << std::setw(16) << (std::to_string(first_step) + "-" + std::to_string(end_step))
+              << std::setw(12) << scene.particles().size()
+              << std::fixed << std::setprecision(1) << std::setw(14) << static_cast<double>(end_step - first_step) / seconds
+              << std::setw(22) << seconds * 1e9 / static_cast<double>(std::max<uint64_t>(particle_steps, 1))
+              << std::setw(20) << static_cast<double>(peak_memory_in_bytes()) / (1024. * 1024.)
+              << std::setw(20) << std::hex << checksum(scene.particles()) << std::dec << '\n';
+}
+
+/// Runs what the options ask for, and returns the exit code of the program
+static auto run_all(Options const& options) -> int
+{
+    // Runs on machines without a GPU too, with LIBGL_ALWAYS_SOFTWARE=1 (Mesa's llvmpipe)
+    if (options.check_gpu)
+    {
+        gl::init_headless();
+        if (!GpuParticleSystem::is_supported())
+        {
+            std::cerr << "The GPU simulation needs OpenGL 4.3, with shader storage buffers in vertex shaders\n";
+            return 1;
+        }
+        return check_gpu_simulation(4096, options.steps_count, options.dt, options.seed) ? 0 : 1;
+    }
+
+    // The app doesn't use a fixed seed, so its session can only be reproduced from one of the snapshots it saved (snapshot_0.bin to replay it all)
+    if (!options.replay.empty() && options.load_snapshot.empty())
+    {
+        std::cerr << "--replay needs a snapshot to start from, see --load-snapshot\n";
+        return 1;
+    }
+
+    if (!options.replay.empty())
+    {
+        print_header();
+        SceneRecording const recording = load_recording(options.replay);
+        Scene                scene{{}}; // The one of the app
+        scene.restore(load_snapshot(options.load_snapshot));
+        run(options.replay.filename().string(), scene, recording.steps.size(), [&](uint64_t step) { return recording.steps[step]; }, options);
+        return 0;
+    }
+
+    auto scenarios = all_scenarios(options.seed);
+    std::erase_if(scenarios, [&](Scenario const& scenario) { return scenario.name.find(options.filter) == std::string::npos; });
+    if ((!options.load_snapshot.empty() || !options.save_snapshot.empty()) && scenarios.size() != 1)
+    {
+        std::cerr << "Snapshots can only be used with a single scenario, see --filter\n";
+        return 1;
+    }
+
+    print_header();
+    for (Scenario const& scenario : scenarios)
+    {
+        rng::set_seed(options.seed); // Everything random in the scene is drawn on this thread, so it gets the same numbers in every run
+        Scene scene{scenario.scene};
+        if (!options.load_snapshot.empty())
+            scene.restore(load_snapshot(options.load_snapshot)); // Runs --steps more steps from there
+
+        run(scenario.name, scene, scene.steps_count() + options.steps_count, [&](uint64_t step) {
+            return SceneRecording::Step{.dt = options.dt, .input = scenario.input(static_cast<float>(step) * options.dt)};
+        }, options);
+    }
+    return 0;
+}
+
+/// Returns false if `text` is not a number of type T, with nothing after it
+template<typename T>
+static auto parse_number(std::string_view text, T& number) -> bool
+{
+    auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), number); // NOLINT(*pointer-arithmetic)
+    return error == std::errc{} && end == text.data() + text.size();                         // NOLINT(*pointer-arithmetic)
+}
+
+static constexpr std::string_view usage = " [--filter=<part of a name>] [--steps=<n>] [--dt=<seconds>] [--seed=<n>] [--load-snapshot=<path>] [--save-snapshot=<path>] [--replay=<inputs.bin> --load-snapshot=<path>] [--check-gpu]\n";
+
+int main(int argc, char** argv)
+{
+    Options options{};
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view const argument{argv[i]}; // NOLINT(*pointer-arithmetic)
+        auto const             value    = std::string{argument.substr(std::min(argument.find('=') + 1, argument.size()))};
+        bool                   is_valid = true;
+        if (argument.starts_with("--filter="))
+            options.filter = value;
+        else if (argument.starts_with("--steps="))
+            is_valid = parse_number(value, options.steps_count);
+        else if (argument.starts_with("--dt="))
+            is_valid = parse_number(value, options.dt) && options.dt > 0.f;
+        else if (argument.starts_with("--seed="))
+            is_valid = parse_number(value, options.seed);
+        else if (argument.starts_with("--replay="))
+            options.replay = value;
+        else if (argument.starts_with("--load-snapshot="))
+            options.load_snapshot = value;
+        else if (argument.starts_with("--save-snapshot="))
+            options.save_snapshot = value;
+        else if (argument == "--check-gpu")
+            options.check_gpu = true;
+        else
+        {
+            std::cerr << "Unknown argument: " << argument << "\nUsage: " << argv[0] << usage;
+            return 1;
+        }
+        if (!is_valid)
+        {
+            std::cerr << "Invalid value: " << argument << "\nUsage: " << argv[0] << usage;
+            return 1;
+        }
+    }
+
+    // Loading a snapshot or a recording throws if the file is missing, truncated or incompatible
+    try
+    {
+        return run_all(options);
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
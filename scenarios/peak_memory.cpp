@@ -0,0 +1,28 @@
+#include "peak_memory.hpp"
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+// Must come after windows.h
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+auto peak_memory_in_bytes() -> size_t
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss); // Already in bytes
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // In kilobytes
+#endif
+#endif
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include <cstddef>
+
+/// Highest amount of physical memory used by the process since it started, in bytes (resident set size on POSIX, working set on Windows).
+/// Returns 0 when the platform doesn't report it.
+auto peak_memory_in_bytes() -> size_t;
@@ -0,0 +1,113 @@
+#include "ArcLengthTable.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+/// 5-point Gauss–Legendre quadrature on [-1, 1]
+static constexpr std::array<double, 5> gauss_legendre_nodes{-0.9061798459386640, -0.5384693101056831, 0., 0.5384693101056831, 0.9061798459386640};
+static constexpr std::array<double, 5> gauss_legendre_weights{0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891};
+
+static auto speed(Curve const& curve, double t) -> double
+{
+    return glm::length(curve.derivative(static_cast<float>(t)));
+}
+
+/// Length of the curve between the parameters a and b
+static auto gauss_legendre(Curve const& curve, double a, double b) -> double
+{
+    double const middle    = (a + b) / 2.;
+    double const half_size = (b - a) / 2.;
+    double       sum{0.};
+    for (size_t i = 0; i < gauss_legendre_nodes.size(); ++i)
+        sum += gauss_legendre_weights[i] * speed(curve, middle + half_size * gauss_legendre_nodes[i]);
+    return sum * half_size;
+}
+
+/// Splits [a, b] in two until the sum of the two halves agrees with the whole interval
+static auto adaptive_gauss_legendre(Curve const& curve, double a, double b, double whole, double tolerance, int max_depth) -> double // NOLINT(*-no-recursion)
+{
+    double const middle = (a + b) / 2.;
+    double const left   = gauss_legendre(curve, a, middle);
+    double const right  = gauss_legendre(curve, middle, b);
+    if (max_depth == 0 || std::abs(left + right - whole) <= tolerance)
+        return left + right;
+    return adaptive_gauss_legendre(curve, a, middle, left, tolerance / 2., max_depth - 1)
+         + adaptive_gauss_legendre(curve, middle, b, right, tolerance / 2., max_depth - 1);
+}
+
+ArcLengthTable::ArcLengthTable(size_t resolution)
+    : _parameters(resolution)
+{
+    assert(resolution >= 2);
+}
+
+void ArcLengthTable::update(Curve const& curve)
+{
+    if (_curve == &curve && _curve_version == curve.version())
+        return;
+    rebuild(curve);
+    _curve         = &curve;
+    _curve_version = curve.version();
+}
+
+void ArcLengthTable::rebuild(Curve const& curve)
+{
+    // Cumulative lengths on a grid of parameters. The grid is aligned on the segments, so that the quadrature never straddles a discontinuity of the derivative.
+    size_t const segments_count         = curve.segments_count();
+    size_t const intervals_per_segment  = std::max<size_t>(1, (_parameters.size() + segments_count - 1) / segments_count);
+    size_t const intervals_count        = segments_count * intervals_per_segment;
+    std::vector<double> grid_parameters(intervals_count + 1);
+    std::vector<double> grid_lengths(intervals_count + 1);
+    for (size_t k = 0; k <= intervals_count; ++k)
+        grid_parameters[k] = static_cast<double>(k) / static_cast<double>(intervals_count);
+    for (size_t k = 0; k < intervals_count; ++k)
+    {
+        double const a      = grid_parameters[k];
+        double const b      = grid_parameters[k + 1];
+        grid_lengths[k + 1] = grid_lengths[k] + adaptive_gauss_legendre(curve, a, b, gauss_legendre(curve, a, b), 1e-7, 8);
+    }
+    _length = static_cast<float>(grid_lengths.back());
+
+    // Inversion: for each evenly spaced length, find its grid interval, interpolate linearly, then refine with Newton's method (the derivative of the length is the speed)
+    size_t const resolution = _parameters.size();
+    size_t       k          = 0;
+    for (size_t i = 0; i < resolution; ++i)
+    {
+        double const target = static_cast<double>(i) / static_cast<double>(resolution - 1) * grid_lengths.back();
+        while (k + 1 < intervals_count && grid_lengths[k + 1] < target)
+            ++k;
+        double const interval_length = grid_lengths[k + 1] - grid_lengths[k];
+        double const a               = grid_parameters[k];
+        double const b               = grid_parameters[k + 1];
+        double       t               = interval_length > 0. ? a + (target - grid_lengths[k]) / interval_length * (b - a) : a;
+        for (int iteration = 0; iteration < 2; ++iteration)
+        {
+            double const error = grid_lengths[k] + gauss_legendre(curve, a, t) - target;
+            double const v     = speed(curve, t);
+            if (v > 1e-12)
+                t = std::clamp(t - error / v, a, b);
+        }
+        _parameters[i] = static_cast<float>(t);
+    }
+    _parameters.front() = 0.f;
+    _parameters.back()  = 1.f;
+}
+
+auto ArcLengthTable::parameter_at_fraction(float fraction) const -> float
+{
+    float const  x = glm::clamp(fraction, 0.f, 1.f) * static_cast<float>(_parameters.size() - 1);
+    size_t const i = std::min(static_cast<size_t>(x), _parameters.size() - 2);
+    return glm::mix(_parameters[i], _parameters[i + 1], x - static_cast<float>(i));
+}
+
+auto ArcLengthTable::parameter_at_length(float length) const -> float
+{
+    return _length > 0.f ? parameter_at_fraction(length / _length) : 0.f;
+}
+
+void ArcLengthTable::fractions_to_parameters(std::span<float> values) const
+{
+    for (float& value : values)
+        value = parameter_at_fraction(value);
+}
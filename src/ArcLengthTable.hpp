@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Curve.hpp"
+
+/// Maps distances along a curve to curve parameters, so that particles can move at constant speed along the curve, or be spawned uniformly on it.
+/// The table stores the parameter t for evenly spaced arc lengths, which makes the inversion O(1): a lookup and a linear interpolation.
+class ArcLengthTable {
+public:
+    explicit ArcLengthTable(size_t resolution = 256);
+
+    /// Rebuilds the table if it was built for another curve, or if the curve changed since then. Does nothing otherwise.
+    void update(Curve const&);
+
+    auto length() const -> float { return _length; }
+    /// Parameter of the point at the given distance from the start of the curve
+    auto parameter_at_length(float length) const -> float;
+    /// Parameter of the point at the given fraction of the length of the curve
+    auto parameter_at_fraction(float fraction) const -> float;
+    /// Replaces each fraction of the length by the corresponding parameter
+    void fractions_to_parameters(std::span<float> values) const;
+
+private:
+    void rebuild(Curve const&);
+
+private:
+    std::vector<float> _parameters; // _parameters[i] is the parameter at length i / (resolution - 1) * _length
+    float              _length{0.f};
+
+    Curve const* _curve{nullptr};
+    uint64_t     _curve_version{0};
+};
@@ -0,0 +1,216 @@
+#include "Curve.hpp"
+#include <array>
+#include <cassert>
+#include <cmath>
+#include "bezier.hpp"
+
+static auto horner(std::span<glm::vec2 const> coefficients, float u) -> glm::vec2
+{
+    if (coefficients.empty())
+        return glm::vec2{0.f};
+    glm::vec2 res = coefficients.back();
+    for (size_t k = coefficients.size() - 1; k-- > 0;)
+        res = res * u + coefficients[k];
+    return res;
+}
+
+/// Matrix M of a segment of a uniform B-spline: the coefficient of u^i in the segment is the sum over j of M[i][j] * P[j].
+/// Stored row-major, (degree + 1)². See "General matrix representations for B-splines", K. Qin, 2000.
+static auto bspline_basis_matrix(size_t degree) -> std::vector<double>
+{
+    size_t const order = degree + 1;
+    double       degree_factorial{1.};
+    for (size_t i = 2; i <= degree; ++i)
+        degree_factorial *= static_cast<double>(i);
+
+    std::vector<double> matrix(order * order);
+    for (size_t i = 0; i < order; ++i)
+    {
+        for (size_t j = 0; j < order; ++j)
+        {
+            double sum{0.};
+            for (size_t s = j; s < order; ++s)
+                sum += ((s - j) % 2 == 0 ? 1. : -1.) * binomial(order, s - j) * std::pow(static_cast<double>(degree - s), static_cast<double>(degree - i)); // std::pow(0, 0) is 1, as we need
+            matrix[i * order + j] = binomial(degree, i) * sum / degree_factorial;
+        }
+    }
+    return matrix;
+}
+
+/// 8-point Gauss–Legendre quadrature on [-1, 1]
+static constexpr std::array<double, 8> gauss_legendre_nodes{-0.9602898564975363, -0.7966664774136267, -0.5255324099163290, -0.1834346424956498, 0.1834346424956498, 0.5255324099163290, 0.7966664774136267, 0.9602898564975363};
+static constexpr std::array<double, 8> gauss_legendre_weights{0.1012285362903763, 0.2223810344533745, 0.3137066458778873, 0.3626837833783620, 0.3626837833783620, 0.3137066458778873, 0.2223810344533745, 0.1012285362903763};
+
+Curve::Curve(Curve_Descriptor desc)
+    : _kind{desc.kind}
+    , _degree{desc.kind == CurveKind::Bezier ? desc.control_points.size() - 1 : desc.degree}
+    , _control_points{std::move(desc.control_points)}
+{
+    update_cache();
+}
+
+void Curve::set_control_points(std::vector<glm::vec2> control_points)
+{
+    if (_kind == CurveKind::Bezier)
+        _degree = control_points.size() - 1;
+    _control_points = std::move(control_points);
+    update_cache();
+}
+
+void Curve::set_control_point(size_t index, glm::vec2 position)
+{
+    if (_control_points.at(index) == position)
+        return;
+    _control_points[index] = position;
+    update_cache();
+}
+
+void Curve::update_cache()
+{
+    size_t const points_count = _control_points.size();
+    size_t const order        = _degree + 1;
+    assert(points_count >= 1);
+    switch (_kind)
+    {
+    case CurveKind::Bezier:
+        _segments_count = 1;
+        break;
+    case CurveKind::CompositeBezier:
+        assert(_degree >= 1 && (points_count - 1) % _degree == 0 && "A composite Bézier curve needs degree * segments_count + 1 control points.");
+        _segments_count = (points_count - 1) / _degree;
+        break;
+    case CurveKind::UniformBSpline:
+        assert(points_count > _degree && "A uniform B-spline needs more control points than its degree.");
+        _segments_count = points_count - _degree;
+        break;
+    }
+
+    // Power basis
+    _coefficients.resize(_segments_count * order);
+    if (_kind == CurveKind::UniformBSpline)
+    {
+        auto const matrix = bspline_basis_matrix(_degree);
+        for (size_t s = 0; s < _segments_count; ++s)
+        {
+            for (size_t i = 0; i < order; ++i)
+            {
+                glm::dvec2 coefficient{0.};
+                for (size_t j = 0; j < order; ++j)
+                    coefficient += matrix[i * order + j] * glm::dvec2{_control_points[s + j]};
+                _coefficients[s * order + i] = coefficient;
+            }
+        }
+    }
+    else
+    {
+        for (size_t s = 0; s < _segments_count; ++s)
+            bezier_to_power_basis(std::span{_control_points}.subspan(s * _degree, order), std::span{_coefficients}.subspan(s * order, order));
+    }
+
+    // Derivative
+    _derivative_coefficients.resize(_segments_count * _degree);
+    for (size_t s = 0; s < _segments_count; ++s)
+    {
+        for (size_t k = 0; k < _degree; ++k)
+            _derivative_coefficients[s * _degree + k] = static_cast<float>(k + 1) * _coefficients[s * order + k + 1];
+    }
+
+    // Bounding box: the extremities of the segments, plus the points where the derivative of x or y vanishes
+    _bounding_box = BoundingBox{.min = evaluate(0.f), .max = evaluate(0.f)};
+    auto const extend = [&](glm::vec2 p) {
+        _bounding_box.min = glm::min(_bounding_box.min, p);
+        _bounding_box.max = glm::max(_bounding_box.max, p);
+    };
+    for (size_t s = 0; s < _segments_count; ++s)
+    {
+        auto const position   = segment_coefficients(s);
+        auto const derivative = segment_derivative_coefficients(s);
+        extend(horner(position, 1.f));
+        // The derivative has at most degree - 1 roots: finding the sign changes on a grid finer than that, then refining them by bisection, catches them all in practice.
+        size_t const samples_count = 4 * _degree + 1;
+        for (glm::length_t axis = 0; axis < 2; ++axis)
+        {
+            float u0 = 0.f;
+            float d0 = horner(derivative, u0)[axis];
+            for (size_t i = 1; i <= samples_count; ++i)
+            {
+                float const u1 = static_cast<float>(i) / static_cast<float>(samples_count);
+                float const d1 = horner(derivative, u1)[axis];
+                if ((d0 < 0.f) != (d1 < 0.f))
+                {
+                    float low  = u0;
+                    float high = u1;
+                    for (int iteration = 0; iteration < 32; ++iteration)
+                    {
+                        float const middle = (low + high) / 2.f;
+                        if ((horner(derivative, middle)[axis] < 0.f) == (d0 < 0.f))
+                            low = middle;
+                        else
+                            high = middle;
+                    }
+                    extend(horner(position, (low + high) / 2.f));
+                }
+                u0 = u1;
+                d0 = d1;
+            }
+        }
+    }
+
+    // Length: 4 Gauss–Legendre intervals per segment
+    _length = 0.f;
+    for (size_t s = 0; s < _segments_count; ++s)
+    {
+        auto const derivative = segment_derivative_coefficients(s);
+        for (int interval = 0; interval < 4; ++interval)
+        {
+            double const u0 = interval / 4.;
+            for (size_t i = 0; i < gauss_legendre_nodes.size(); ++i)
+            {
+                double const u = u0 + (gauss_legendre_nodes[i] + 1.) / 8.;
+                _length += static_cast<float>(gauss_legendre_weights[i] / 8.) * glm::length(horner(derivative, static_cast<float>(u)));
+            }
+        }
+    }
+
+    ++_version;
+}
+
+auto Curve::segment_coefficients(size_t segment) const -> std::span<glm::vec2 const>
+{
+    return std::span{_coefficients}.subspan(segment * (_degree + 1), _degree + 1);
+}
+
+auto Curve::segment_derivative_coefficients(size_t segment) const -> std::span<glm::vec2 const>
+{
+    return std::span{_derivative_coefficients}.subspan(segment * _degree, _degree);
+}
+
+auto Curve::locate(float t) const -> std::pair<size_t, float>
+{
+    float const  x       = glm::clamp(t, 0.f, 1.f) * static_cast<float>(_segments_count);
+    size_t const segment = std::min(static_cast<size_t>(x), _segments_count - 1);
+    return {segment, x - static_cast<float>(segment)};
+}
+
+glm::vec2 Curve::evaluate(float t) const
+{
+    auto const [segment, u] = locate(t);
+    return horner(segment_coefficients(segment), u);
+}
+
+glm::vec2 Curve::derivative(float t) const
+{
+    auto const [segment, u] = locate(t);
+    return static_cast<float>(_segments_count) * horner(segment_derivative_coefficients(segment), u);
+}
+
+void Curve::evaluate(std::span<float const> ts, std::span<float> xs, std::span<float> ys) const
+{
+    assert(ts.size() == xs.size() && ts.size() == ys.size());
+    for (size_t i = 0; i < ts.size(); ++i)
+    {
+        glm::vec2 const position = evaluate(ts[i]);
+        xs[i]                    = position.x;
+        ys[i]                    = position.y;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include "glm/glm.hpp"
+
+enum class CurveKind {
+    Bezier,          // A single segment, of degree control_points.size() - 1
+    CompositeBezier, // Segments of the given degree that share their end points: degree * segments_count + 1 control points
+    UniformBSpline,  // Uniform B-spline of the given degree: control_points.size() - degree segments
+};
+
+struct Curve_Descriptor {
+    CurveKind              kind{CurveKind::Bezier};
+    std::vector<glm::vec2> control_points{};
+    size_t                 degree{3}; // Ignored for CurveKind::Bezier
+};
+
+struct BoundingBox {
+    glm::vec2 min{};
+    glm::vec2 max{};
+};
+
+/// Piecewise polynomial curve, parameterized by t in [0, 1] over all its segments.
+/// Each time the control points change, the segments are converted to the power basis, along with their derivative,
+/// and the bounding box and length are updated. Queries then only cost a Horner evaluation.
+class Curve {
+public:
+    explicit Curve(Curve_Descriptor desc);
+
+    void set_control_points(std::vector<glm::vec2> control_points);
+    /// Does nothing if the point is already at that position, so that the version only changes when the curve does
+    void set_control_point(size_t index, glm::vec2 position);
+
+    glm::vec2 evaluate(float t) const;
+    /// Evaluates the curve at each parameter, and writes the result as SoA. `ts` can alias `xs` or `ys`.
+    void evaluate(std::span<float const> ts, std::span<float> xs, std::span<float> ys) const;
+    /// Derivative with respect to t (the global parameter, not the one of the segment)
+    glm::vec2 derivative(float t) const;
+
+    auto bounding_box() const -> BoundingBox const& { return _bounding_box; }
+    auto length() const -> float { return _length; }
+
+    auto kind() const -> CurveKind { return _kind; }
+    auto degree() const -> size_t { return _degree; }
+    auto segments_count() const -> size_t { return _segments_count; }
+    auto control_points() const -> std::vector<glm::vec2> const& { return _control_points; }
+    /// Incremented each time the control points change, so that data derived from the curve knows when to rebuild itself
+    auto version() const -> uint64_t { return _version; }
+
+    /// Power basis coefficients of a segment (degree + 1 values, constant term first) and of its derivative with respect to the segment's own parameter (degree values)
+    auto segment_coefficients(size_t segment) const -> std::span<glm::vec2 const>;
+    auto segment_derivative_coefficients(size_t segment) const -> std::span<glm::vec2 const>;
+
+    /// Segment containing the global parameter t, and the local parameter in that segment
+    auto locate(float t) const -> std::pair<size_t, float>;
+
+private:
+    void update_cache();
+
+private:
+    CurveKind              _kind;
+    size_t                 _degree;
+    std::vector<glm::vec2> _control_points;
+
+    size_t                 _segments_count{};
+    std::vector<glm::vec2> _coefficients{};            // segments_count * (degree + 1)
+    std::vector<glm::vec2> _derivative_coefficients{}; // segments_count * degree
+    BoundingBox            _bounding_box{};
+    float                  _length{};
+    uint64_t               _version{0};
+};
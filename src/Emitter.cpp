@@ -0,0 +1,88 @@
+#include "Emitter.hpp"
+#include <array>
+#include <cmath>
+#include "bezier.hpp"
+#include "rng.hpp"
+#include "sampling.hpp"
+
+static void fill_uniform(std::span<float> values, Range range)
+{
+    rng::rand_fill(values, range.min, range.max);
+}
+
+static void fill_constant(std::span<float> values, float value)
+{
+    std::fill(values.begin(), values.end(), value);
+}
+
+static void spawn_positions(EmitterShape::Point const& shape, std::span<float> xs, std::span<float> ys)
+{
+    fill_constant(xs, shape.position.x);
+    fill_constant(ys, shape.position.y);
+}
+
+static void spawn_positions(EmitterShape::Disk const& shape, std::span<float> xs, std::span<float> ys)
+{
+    sampling::fill_disk(xs, ys, shape.center, shape.radius);
+}
+
+static void spawn_positions(EmitterShape::Line const& shape, std::span<float> xs, std::span<float> ys)
+{
+    fill_uniform(xs, {0.f, 1.f});
+    for (size_t i = 0; i < xs.size(); ++i)
+    {
+        glm::vec2 const position = glm::mix(shape.start, shape.end, xs[i]);
+        xs[i]                    = position.x;
+        ys[i]                    = position.y;
+    }
+}
+
+static void spawn_positions(EmitterShape::Bezier const& shape, std::span<float> xs, std::span<float> ys)
+{
+    fill_uniform(xs, {0.f, 1.f});
+    bezier_evaluate(std::array{shape.p0, shape.p1, shape.p2, shape.p3}, xs, xs, ys); // The parameters are drawn in xs and replaced in place by the positions
+}
+
+static void spawn_positions(EmitterShape::Curve const& shape, std::span<float> xs, std::span<float> ys)
+{
+    fill_uniform(xs, {0.f, 1.f});
+    shape.arc_lengths->fractions_to_parameters(xs);
+    shape.curve->evaluate(xs, xs, ys);
+}
+
+auto Emitter::burst(ParticlePool& pool, size_t count) const -> IndexRange
+{
+    IndexRange const range    = pool.spawn(count);
+    auto const       new_ones = [&](ParticleAttribute attr) {
+        return pool.attribute(attr).subspan(range.begin, range.size());
+    };
+
+    std::visit([&](auto&& shape) { spawn_positions(shape, new_ones(ParticleAttribute::PositionX), new_ones(ParticleAttribute::PositionY)); }, _desc.shape);
+
+    { // Velocity: draw the speed and the angle in the velocity arrays, then convert them in place.
+        auto const vx = new_ones(ParticleAttribute::VelocityX);
+        auto const vy = new_ones(ParticleAttribute::VelocityY);
+        fill_uniform(vx, _desc.speed);
+        fill_uniform(vy, _desc.direction);
+        for (size_t i = 0; i < vx.size(); ++i)
+        {
+            float const speed = vx[i];
+            float const angle = vy[i];
+            vx[i]             = speed * std::cos(angle);
+            vy[i]             = speed * std::sin(angle);
+        }
+    }
+
+    fill_uniform(new_ones(ParticleAttribute::Mass), _desc.mass);
+    fill_uniform(new_ones(ParticleAttribute::Lifespan), _desc.lifespan);
+
+    return range;
+}
+
+void Emitter::update(ParticlePool& pool, float delta_time)
+{
+    _pending_particles += _desc.rate * delta_time;
+    float const count = std::floor(_pending_particles);
+    _pending_particles -= count;
+    burst(pool, static_cast<size_t>(count));
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <utility>
+#include <variant>
+#include "ArcLengthTable.hpp"
+#include "Curve.hpp"
+#include "ParticlePool.hpp"
+#include "glm/glm.hpp"
+
+/// Values are drawn uniformly in [min, max]
+struct Range {
+    float min{};
+    float max{};
+};
+
+namespace EmitterShape {
+struct Point {
+    glm::vec2 position{};
+};
+struct Disk {
+    glm::vec2 center{};
+    float     radius{};
+};
+struct Line {
+    glm::vec2 start{};
+    glm::vec2 end{};
+};
+struct Bezier {
+    glm::vec2 p0{};
+    glm::vec2 p1{};
+    glm::vec2 p2{};
+    glm::vec2 p3{};
+};
+/// Spawns uniformly along the length of the curve. Both must outlive the emitter, and the table must be up to date with the curve.
+struct Curve {
+    ::Curve const*        curve{};
+    ArcLengthTable const* arc_lengths{};
+};
+} // namespace EmitterShape
+
+using AnyEmitterShape = std::variant<
+    EmitterShape::Point,
+    EmitterShape::Disk,
+    EmitterShape::Line,
+    EmitterShape::Bezier,
+    EmitterShape::Curve>;
+
+struct Emitter_Descriptor {
+    AnyEmitterShape shape{EmitterShape::Point{}};
+    float           rate{0.f}; // Particles per second, spawned continuously by update()
+    Range           lifespan{5.f, 15.f};
+    Range           mass{1.f, 2.f};
+    Range           speed{0.f, 0.f};
+    Range           direction{0.f, 6.2831853f}; // Angle of the initial velocity, in radians
+};
+
+/// Spawns particles into a ParticlePool.
+/// New particles are written in bulk, one attribute array at a time, instead of one particle at a time.
+class Emitter {
+public:
+    explicit Emitter(Emitter_Descriptor desc)
+        : _desc{std::move(desc)}
+    {}
+
+    /// Spawns the particles due for this frame according to the rate. Fractions of particles carry over to the next frames.
+    void update(ParticlePool&, float delta_time);
+    /// Spawns `count` particles right away (or fewer if the pool is full). Returns the indices of the new particles.
+    auto burst(ParticlePool&, size_t count) const -> IndexRange;
+
+    auto descriptor() -> Emitter_Descriptor& { return _desc; }
+    auto descriptor() const -> Emitter_Descriptor const& { return _desc; }
+
+    /// Fraction of a particle carried over to the next update(). Part of the state saved in snapshots.
+    auto pending_particles() const -> float { return _pending_particles; }
+    void set_pending_particles(float count) { _pending_particles = count; }
+
+private:
+    Emitter_Descriptor _desc;
+    float              _pending_particles{0.f};
+};
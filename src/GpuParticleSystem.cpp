@@ -0,0 +1,302 @@
+#include "GpuParticleSystem.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/// Layout of a particle in the shader storage buffer (std430). Must match the Particle struct of the shaders.
+struct GpuParticle {
+    glm::vec2 position{};
+    glm::vec2 velocity{};
+    float     mass{};
+    float     age{};
+    float     lifespan{};
+    float     padding{};
+};
+static_assert(sizeof(GpuParticle) == 32);
+
+static constexpr GLuint work_group_size                   = 256;
+static constexpr GLint  draw_vertex_shader_storage_blocks = 2; // The particles and the gradient
+
+static auto particles_declaration() -> std::string
+{
+    return R"GLSL(
+struct Particle {
+    vec2  position;
+    vec2  velocity;
+    float mass;
+    float age;
+    float lifespan;
+    float padding;
+};
+
+layout(std430, binding = 0) buffer Particles {
+    Particle particles[];
+};
+)GLSL";
+}
+
+static auto make_update_shader() -> gl::ComputeShader
+{
+    return gl::ComputeShader{{
+        .compute = gl::ShaderSource::Code{"#version 430\n" + particles_declaration() + R"GLSL(
+layout(local_size_x = 256) in;
+
+uniform int   u_count;
+uniform float u_delta_time;
+uniform vec2  u_gravity;
+uniform float u_air_friction;
+uniform float u_curve_attraction;
+uniform vec2  u_p0;
+uniform vec2  u_p1;
+uniform vec2  u_p2;
+uniform vec2  u_p3;
+
+vec2 bezier3(float t)
+{
+    float u = 1. - t;
+    return u * u * u * u_p0 + 3. * u * u * t * u_p1 + 3. * u * t * t * u_p2 + t * t * t * u_p3;
+}
+
+// Same gradient descent as find_closest_t_on_bezier3()
+float find_closest_t(vec2 q)
+{
+    float t = 0.5;
+    for (int i = 0; i < 100; ++i)
+    {
+        float dt = 0.001;
+        vec2  b1 = bezier3(t) - q;
+        vec2  b2 = bezier3(t + dt) - q;
+        t -= 0.01 * (dot(b2, b2) - dot(b1, b1)) / dt;
+        t = clamp(t, 0., 1.);
+    }
+    return t;
+}
+
+// Same as forces::acceleration()
+vec2 acceleration(vec2 velocity, float mass, vec2 to_curve)
+{
+    float distance  = length(to_curve);
+    vec2  direction = distance > 0. ? to_curve / distance : vec2(0.);
+    vec2  force     = u_curve_attraction / (u_curve_attraction + distance) * direction
+                    - u_air_friction * velocity;
+    return u_gravity + force / mass;
+}
+
+void main()
+{
+    int i = int(gl_GlobalInvocationID.x);
+    if (i >= u_count)
+        return;
+    Particle p = particles[i];
+    if (p.age >= p.lifespan)
+        return;
+
+    vec2 to_curve = bezier3(find_closest_t(p.position)) - p.position;
+    p.velocity += acceleration(p.velocity, p.mass, to_curve) * u_delta_time;
+    p.position += p.velocity * u_delta_time;
+    p.age += u_delta_time;
+    particles[i] = p;
+}
+)GLSL"},
+    }};
+}
+
+static auto make_draw_shader() -> gl::Shader
+{
+    return gl::Shader{{
+        .vertex   = gl::ShaderSource::Code{"#version 430\n" + particles_declaration() + R"GLSL(
+layout(std430, binding = 1) readonly buffer Gradient {
+    vec4 gradient[256];
+};
+
+layout(location = 0) in vec2 in_position;
+layout(location = 1) in vec2 in_uv;
+
+uniform float u_radius;
+uniform float u_inverse_aspect_ratio;
+
+out vec2 v_uv;
+out vec4 v_color;
+
+// Same as easing::in_out<3>()
+float ease_in_out_3(float x)
+{
+    return x < 0.5
+               ? 4. * x * x * x
+               : 1. - 4. * (1. - x) * (1. - x) * (1. - x);
+}
+
+void main()
+{
+    Particle p = particles[gl_InstanceID];
+    if (p.age >= p.lifespan)
+    {
+        gl_Position = vec4(2., 2., 2., 1.); // Outside of the screen
+        return;
+    }
+
+    vec2 position = p.position + u_radius * in_position;
+    gl_Position = vec4(position * vec2(u_inverse_aspect_ratio, 1.), 0., 1.);
+    v_uv = in_uv;
+    v_color = gradient[int(clamp(ease_in_out_3(p.age / p.lifespan), 0., 1.) * 255. + 0.5)];
+}
+)GLSL"},
+        .fragment = gl::ShaderSource::Code{R"GLSL(
+#version 430
+
+out vec4 out_color;
+
+in vec2 v_uv;
+in vec4 v_color;
+
+void main()
+{
+    vec2 dir = v_uv - vec2(0.5);
+    if (dot(dir, dir) > 0.25)
+        discard;
+    out_color = v_color;
+}
+)GLSL"},
+    }};
+}
+
+static auto make_square_mesh() -> gl::Mesh
+{
+    return gl::Mesh{gl::Mesh_Descriptor{
+        .vertex_buffers = {
+            gl::VertexBuffer_Descriptor{
+                .layout = {gl::VertexAttribute::Position2D(0), gl::VertexAttribute::UV(1)},
+                .data   = {
+                    -1.f, -1.f, 0.f, 0.f, //
+                    +1.f, -1.f, 1.f, 0.f, //
+                    +1.f, +1.f, 1.f, 1.f, //
+                    -1.f, +1.f, 0.f, 1.f  //
+                }
+            }
+        },
+        .index_buffer = {0, 1, 2, 0, 2, 3},
+    }};
+}
+
+auto GpuParticleSystem::is_supported() -> bool
+{
+    if (!gl::supports_compute_shaders())
+        return false;
+    GLint max_vertex_storage_blocks{};
+    glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &max_vertex_storage_blocks); // Can be 0 in OpenGL 4.3
+    return max_vertex_storage_blocks >= draw_vertex_shader_storage_blocks;
+}
+
+GpuParticleSystem::GpuParticleSystem(size_t capacity)
+    : _capacity{capacity}
+    , _update_shader{make_update_shader()}
+    , _draw_shader{make_draw_shader()}
+    , _square_mesh{make_square_mesh()}
+{
+    std::vector<GpuParticle> const dead_particles(capacity, GpuParticle{.age = 1.f, .lifespan = 0.f});
+    glGenBuffers(1, &_particles_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _particles_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(GpuParticle)), dead_particles.data(), GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &_gradient_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _gradient_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(Gradient::lut_size * sizeof(glm::vec4)), nullptr, GL_DYNAMIC_DRAW);
+}
+
+GpuParticleSystem::~GpuParticleSystem()
+{
+    glDeleteBuffers(1, &_particles_buffer);
+    glDeleteBuffers(1, &_gradient_buffer);
+}
+
+void GpuParticleSystem::spawn(ParticlePool const& new_particles)
+{
+    size_t const count = std::min(new_particles.size(), _capacity);
+    if (count == 0)
+        return;
+
+    std::vector<GpuParticle> particles(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        particles[i] = GpuParticle{
+            .position = {new_particles.x()[i], new_particles.y()[i]},
+            .velocity = {new_particles.vx()[i], new_particles.vy()[i]},
+            .mass     = new_particles.mass()[i],
+            .age      = new_particles.age()[i],
+            .lifespan = new_particles.lifespan()[i],
+            .padding  = 0.f,
+        };
+    }
+
+    // Might wrap around the end of the buffer, in which case it takes two uploads
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _particles_buffer);
+    size_t const first_part_count = std::min(count, _capacity - _next_slot);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(_next_slot * sizeof(GpuParticle)), static_cast<GLsizeiptr>(first_part_count * sizeof(GpuParticle)), particles.data());
+    if (first_part_count < count)
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>((count - first_part_count) * sizeof(GpuParticle)), particles.data() + first_part_count);
+    _used_slots = std::min(_capacity, std::max(_used_slots, _next_slot + count));
+    _next_slot  = (_next_slot + count) % _capacity;
+}
+
+void GpuParticleSystem::update(float delta_time, forces::Parameters const& params, std::array<glm::vec2, 4> const& curve)
+{
+    if (_used_slots == 0)
+        return;
+    _update_shader.bind();
+    _update_shader.set_uniform("u_count", static_cast<int>(_used_slots));
+    _update_shader.set_uniform("u_delta_time", delta_time);
+    _update_shader.set_uniform("u_gravity", params.gravity);
+    _update_shader.set_uniform("u_air_friction", params.air_friction);
+    _update_shader.set_uniform("u_curve_attraction", params.curve_attraction);
+    _update_shader.set_uniform("u_p0", curve[0]);
+    _update_shader.set_uniform("u_p1", curve[1]);
+    _update_shader.set_uniform("u_p2", curve[2]);
+    _update_shader.set_uniform("u_p3", curve[3]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _particles_buffer);
+    _update_shader.dispatch(static_cast<GLuint>((_used_slots + work_group_size - 1) / work_group_size));
+    // The next draw() and read_back() must see the new values
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void GpuParticleSystem::draw(Gradient const& color_over_lifetime, float radius) const
+{
+    if (_used_slots == 0)
+        return;
+    auto const lut = color_over_lifetime.lut();
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _gradient_buffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(lut.size_bytes()), lut.data());
+
+    _draw_shader.bind();
+    _draw_shader.set_uniform("u_radius", radius);
+    _draw_shader.set_uniform("u_inverse_aspect_ratio", 1.f / gl::framebuffer_aspect_ratio());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _particles_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _gradient_buffer);
+    _square_mesh.draw_instanced(_used_slots);
+}
+
+void GpuParticleSystem::read_back(ParticlePool& pool) const
+{
+    std::vector<GpuParticle> particles(_used_slots);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _particles_buffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(_used_slots * sizeof(GpuParticle)), particles.data());
+
+    pool.clear();
+    auto const alive_count = static_cast<size_t>(std::count_if(particles.begin(), particles.end(), [](GpuParticle const& p) {
+        return p.age < p.lifespan;
+    }));
+    IndexRange const range = pool.spawn(alive_count);
+    size_t           i     = range.begin;
+    for (GpuParticle const& p : particles)
+    {
+        if (p.age >= p.lifespan || i == range.end)
+            continue;
+        pool.x()[i]        = p.position.x;
+        pool.y()[i]        = p.position.y;
+        pool.vx()[i]       = p.velocity.x;
+        pool.vy()[i]       = p.velocity.y;
+        pool.mass()[i]     = p.mass;
+        pool.age()[i]      = p.age;
+        pool.lifespan()[i] = p.lifespan;
+        ++i;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <array>
+#include "Gradient.hpp"
+#include "ParticlePool.hpp"
+#include "forces.hpp"
+#include "glm/glm.hpp"
+#include "opengl-framework/opengl-framework.hpp"
+
+/// Particles that live in GPU memory (a shader storage buffer), updated by a compute shader and drawn straight from that buffer.
+/// The CPU only uploads the newly spawned particles, and reads the particles back when explicitly asked to.
+/// Check is_supported() before creating one, and use a ParticlePool on the CPU otherwise.
+class GpuParticleSystem {
+public:
+    /// Whether the context has OpenGL 4.3, and lets vertex shaders read shader storage buffers, which OpenGL 4.3 doesn't require
+    static auto is_supported() -> bool;
+
+    explicit GpuParticleSystem(size_t capacity);
+    ~GpuParticleSystem();
+    GpuParticleSystem(GpuParticleSystem const&)                    = delete;
+    auto operator=(GpuParticleSystem const&) -> GpuParticleSystem& = delete;
+    GpuParticleSystem(GpuParticleSystem&&)                         = delete;
+    auto operator=(GpuParticleSystem&&) -> GpuParticleSystem&      = delete;
+
+    auto capacity() const -> size_t { return _capacity; }
+
+    /// Uploads all the particles of the pool. The slots are used as a ring buffer: when the system is full, the oldest slots are overwritten, even if their particles are still alive.
+    void spawn(ParticlePool const& new_particles);
+    /// Applies the forces towards the cubic Bézier curve (p0, p1, p2, p3), moves the particles and ages them
+    void update(float delta_time, forces::Parameters const&, std::array<glm::vec2, 4> const& curve);
+    /// Draws the alive particles as disks, colored by the gradient according to their eased relative age
+    void draw(Gradient const& color_over_lifetime, float radius) const;
+
+    /// Copies the alive particles to the pool, replacing its content. Stalls until the GPU is done with the simulation, so avoid doing it every frame.
+    void read_back(ParticlePool& pool) const;
+
+private:
+    size_t _capacity;
+    size_t _next_slot{0};
+    size_t _used_slots{0}; // Slots that have ever been written. The ones after are always dead, so they are neither updated nor drawn.
+    GLuint _particles_buffer{};
+    GLuint _gradient_buffer{};
+
+    gl::ComputeShader _update_shader;
+    gl::Shader        _draw_shader;
+    gl::Mesh          _square_mesh;
+};
@@ -0,0 +1,35 @@
+#include "Gradient.hpp"
+#include <algorithm>
+#include <cassert>
+
+Gradient::Gradient(std::vector<GradientKey> keys)
+    : _keys{std::move(keys)}
+{
+    assert(!_keys.empty() && "A gradient needs at least one key.");
+    std::sort(_keys.begin(), _keys.end(), [](GradientKey const& a, GradientKey const& b) {
+        return a.position < b.position;
+    });
+
+    size_t key = 0; // Last key before the current position
+    for (size_t i = 0; i < lut_size; ++i)
+    {
+        float const position = static_cast<float>(i) / static_cast<float>(lut_size - 1);
+        while (key + 1 < _keys.size() && _keys[key + 1].position <= position)
+            ++key;
+        GradientKey const& before = _keys[key];
+        if (key + 1 == _keys.size() || position <= before.position)
+        {
+            _lut[i] = before.color;
+            continue;
+        }
+        GradientKey const& after = _keys[key + 1];
+        _lut[i]                  = glm::mix(before.color, after.color, (position - before.position) / (after.position - before.position));
+    }
+}
+
+void Gradient::evaluate(std::span<float const> positions, std::span<glm::vec4> colors) const
+{
+    assert(positions.size() == colors.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+        colors[i] = _lut[lut_index(positions[i])];
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <array>
+#include <span>
+#include <vector>
+#include "glm/glm.hpp"
+
+struct GradientKey {
+    float     position{}; // In [0, 1]
+    glm::vec4 color{};
+};
+
+/// Color as a function of a value in [0, 1], typically the relative age of a particle.
+/// The keys are baked into a lookup table once, so evaluating the gradient is a single indexed load instead of a search and an interpolation.
+/// One gradient is meant to be shared by all the particles of an emitter, instead of each particle storing its own colors.
+class Gradient {
+public:
+    static constexpr size_t lut_size = 256;
+
+    /// The keys don't need to be sorted. Before the first key and after the last one, the color is the one of the closest key.
+    explicit Gradient(std::vector<GradientKey> keys);
+
+    auto evaluate(float position) const -> glm::vec4 { return _lut[lut_index(position)]; }
+    /// Writes the color for each position. Both spans must have the same size.
+    void evaluate(std::span<float const> positions, std::span<glm::vec4> colors) const;
+
+    auto keys() const -> std::vector<GradientKey> const& { return _keys; }
+    /// The baked colors, e.g. to upload them to the GPU
+    auto lut() const -> std::span<glm::vec4 const, lut_size> { return _lut; }
+
+private:
+    static auto lut_index(float position) -> size_t
+    {
+        return static_cast<size_t>(glm::clamp(position, 0.f, 1.f) * static_cast<float>(lut_size - 1) + 0.5f);
+    }
+
+private:
+    std::vector<GradientKey>        _keys;
+    std::array<glm::vec4, lut_size> _lut{};
+};
@@ -0,0 +1,71 @@
+#include "ParticlePool.hpp"
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+ParticlePool::ParticlePool(size_t capacity)
+    : _capacity{capacity}
+{
+    for (auto& values : _attributes)
+        values.resize(capacity);
+    _dead.reserve(capacity);
+    _is_dead.resize(capacity, 0);
+}
+
+auto ParticlePool::spawn(size_t count) -> IndexRange
+{
+    auto const range = IndexRange{
+        .begin = _size,
+        .end   = _size + std::min(count, _capacity - _size),
+    };
+    _size = range.end;
+    std::fill(age().begin() + static_cast<std::ptrdiff_t>(range.begin), age().end(), 0.f);
+    return range;
+}
+
+void ParticlePool::kill(size_t index)
+{
+    assert(index < _size);
+    if (_is_dead[index])
+        return;
+    _is_dead[index] = 1;
+    _dead.push_back(static_cast<uint32_t>(index));
+}
+
+void ParticlePool::kill_expired()
+{
+    auto const ages      = age();
+    auto const lifespans = lifespan();
+    for (size_t i = 0; i < _size; ++i)
+    {
+        if (ages[i] > lifespans[i])
+            kill(i);
+    }
+}
+
+void ParticlePool::compact()
+{
+    // Highest indices first: all the dead particles after the current one have already been removed,
+    // so the last particle of the pool is always alive and can be moved into the hole.
+    std::sort(_dead.begin(), _dead.end(), std::greater<>{});
+    for (uint32_t const index : _dead)
+    {
+        size_t const last = _size - 1;
+        if (index != last)
+        {
+            for (auto& values : _attributes)
+                values[index] = values[last];
+        }
+        _is_dead[index] = 0;
+        --_size;
+    }
+    _dead.clear();
+}
+
+void ParticlePool::clear()
+{
+    for (uint32_t const index : _dead)
+        _is_dead[index] = 0;
+    _dead.clear();
+    _size = 0;
+}
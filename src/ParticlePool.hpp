@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+enum class ParticleAttribute : size_t {
+    PositionX,
+    PositionY,
+    VelocityX,
+    VelocityY,
+    Mass,
+    Age,
+    Lifespan,
+    COUNT,
+};
+
+/// Range of particle indices [begin, end)
+struct IndexRange {
+    size_t begin{};
+    size_t end{};
+
+    auto size() const -> size_t { return end - begin; }
+};
+
+/// Fixed-capacity particle storage, with one array per attribute (SoA).
+/// All the memory is allocated in the constructor, so spawning and killing never touch the allocator.
+/// Alive particles always occupy [0, size()): loops over them never have to skip holes.
+class ParticlePool {
+public:
+    explicit ParticlePool(size_t capacity);
+
+    auto size() const -> size_t { return _size; }
+    auto capacity() const -> size_t { return _capacity; }
+
+    /// Appends up to `count` particles at the end of the pool (fewer if it is full) and returns their indices.
+    /// Their age is set to 0, all other attributes must be written by the caller.
+    auto spawn(size_t count) -> IndexRange;
+
+    /// Puts the particle on the dead list. It stays in place until the next compact(), so indices stay valid for the rest of the frame.
+    void kill(size_t index);
+    /// Kills all the particles whose age is greater than their lifespan.
+    void kill_expired();
+    /// Removes the dead particles by moving the last alive ones into their slots (swap-and-pop). O(d log d) for d dead particles, because they are sorted first.
+    void compact();
+    void clear();
+
+    /// Values of an attribute for all the alive particles
+    auto attribute(ParticleAttribute attr) -> std::span<float> { return {_attributes[static_cast<size_t>(attr)].data(), _size}; }
+    auto attribute(ParticleAttribute attr) const -> std::span<float const> { return {_attributes[static_cast<size_t>(attr)].data(), _size}; }
+
+    auto x() -> std::span<float> { return attribute(ParticleAttribute::PositionX); }
+    auto y() -> std::span<float> { return attribute(ParticleAttribute::PositionY); }
+    auto vx() -> std::span<float> { return attribute(ParticleAttribute::VelocityX); }
+    auto vy() -> std::span<float> { return attribute(ParticleAttribute::VelocityY); }
+    auto mass() -> std::span<float> { return attribute(ParticleAttribute::Mass); }
+    auto age() -> std::span<float> { return attribute(ParticleAttribute::Age); }
+    auto lifespan() -> std::span<float> { return attribute(ParticleAttribute::Lifespan); }
+    auto x() const -> std::span<float const> { return attribute(ParticleAttribute::PositionX); }
+    auto y() const -> std::span<float const> { return attribute(ParticleAttribute::PositionY); }
+    auto vx() const -> std::span<float const> { return attribute(ParticleAttribute::VelocityX); }
+    auto vy() const -> std::span<float const> { return attribute(ParticleAttribute::VelocityY); }
+    auto mass() const -> std::span<float const> { return attribute(ParticleAttribute::Mass); }
+    auto age() const -> std::span<float const> { return attribute(ParticleAttribute::Age); }
+    auto lifespan() const -> std::span<float const> { return attribute(ParticleAttribute::Lifespan); }
+
+private:
+    size_t _capacity{};
+    size_t _size{};
+
+    std::array<std::vector<float>, static_cast<size_t>(ParticleAttribute::COUNT)> _attributes{};
+
+    std::vector<uint32_t> _dead{};    // Indices of the particles killed during this frame
+    std::vector<uint8_t>  _is_dead{}; // So that killing a particle twice doesn't put it twice on the dead list
+};
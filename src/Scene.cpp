@@ -0,0 +1,79 @@
+#include "Scene.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "rng.hpp"
+
+Scene::Scene(Scene_Descriptor desc)
+    : _particles{desc.capacity}
+    , _curve{{.kind = CurveKind::Bezier, .control_points = {desc.control_points.begin(), desc.control_points.end()}}}
+    , _emitter{{
+          .shape    = EmitterShape::Curve{&_curve, &_arc_lengths},
+          .rate     = desc.emission_rate,
+          .lifespan = desc.lifespan,
+          .speed    = desc.speed,
+      }}
+    , _obstacles{std::move(desc.obstacles)}
+    , _simulation_parameters{desc.simulation}
+{
+    _simulation_parameters.obstacles = _obstacles;
+    _arc_lengths.update(_curve);
+
+    IndexRange const spawned  = _emitter.burst(_particles, desc.initial_particles);
+    auto const       age      = _particles.age().subspan(spawned.begin, spawned.size());
+    auto const       lifespan = _particles.lifespan().subspan(spawned.begin, spawned.size());
+    rng::rand_fill(age, 0.f, 1.f);
+    for (size_t i = 0; i < age.size(); ++i)
+        age[i] *= lifespan[i];
+}
+
+void Scene::apply(SceneInput const& input)
+{
+    _curve.set_control_point(2, input.mouse_position);
+    _arc_lengths.update(_curve); // Only rebuilt when the curve moved
+}
+
+void Scene::step(SceneInput const& input, float dt)
+{
+    apply(input);
+    simulation::step(_particles, _curve, _simulation_parameters, dt, _scratch);
+    _particles.kill_expired();
+    _particles.compact(); // Removes the dead particles without shifting all the ones after them, unlike std::erase_if
+    _emitter.update(_particles, dt);
+    ++_steps_count;
+}
+
+auto Scene::snapshot() const -> SceneSnapshot
+{
+    SceneSnapshot snapshot{
+        .steps_count       = _steps_count,
+        .pending_particles = _emitter.pending_particles(),
+        .rng               = rng::thread_generator().state(),
+    };
+    std::copy(_curve.control_points().begin(), _curve.control_points().end(), snapshot.control_points.begin());
+    for (size_t attr = 0; attr < snapshot.attributes.size(); ++attr)
+    {
+        auto const values         = _particles.attribute(static_cast<ParticleAttribute>(attr));
+        snapshot.attributes[attr] = {values.begin(), values.end()};
+    }
+    return snapshot;
+}
+
+void Scene::restore(SceneSnapshot const& snapshot)
+{
+    size_t const count = snapshot.attributes[0].size();
+    if (count > _particles.capacity())
+        throw std::runtime_error{"The snapshot has " + std::to_string(count) + " particles, but the scene can only hold " + std::to_string(_particles.capacity())};
+
+    _particles.clear();
+    _particles.spawn(count);
+    for (size_t attr = 0; attr < snapshot.attributes.size(); ++attr)
+        std::copy(snapshot.attributes[attr].begin(), snapshot.attributes[attr].end(), _particles.attribute(static_cast<ParticleAttribute>(attr)).begin());
+
+    _curve.set_control_points({snapshot.control_points.begin(), snapshot.control_points.end()});
+    _arc_lengths.update(_curve);
+    _emitter.set_pending_particles(snapshot.pending_particles);
+    rng::thread_generator().set_state(snapshot.rng);
+    _steps_count = snapshot.steps_count;
+}
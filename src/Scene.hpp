@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "ArcLengthTable.hpp"
+#include "Curve.hpp"
+#include "Emitter.hpp"
+#include "ParticlePool.hpp"
+#include "glm/glm.hpp"
+#include "rng.hpp"
+#include "segments.hpp"
+#include "simulation.hpp"
+
+/// What the user controls, sampled once per step
+struct SceneInput {
+    glm::vec2 mouse_position{}; // Drags the third control point of the curve
+};
+
+struct Scene_Descriptor {
+    size_t                   capacity{2000};
+    std::array<glm::vec2, 4> control_points{{{-0.6f, -0.6f}, {-0.2f, 0.5f}, {0.f, 0.f}, {0.8f, 0.5f}}};
+    size_t                   initial_particles{0}; // Spawned along the curve with random ages, so that they don't all expire at once
+    float                    emission_rate{30.f};  // Particles per second, spawned along the curve
+    Range                    lifespan{5.f, 15.f};
+    Range                    speed{0.f, 0.05f};
+    simulation::Parameters   simulation{};         // Its obstacles are ignored, use the ones below
+    std::vector<Segment>     obstacles{};
+};
+
+/// Everything that changes while a Scene runs. Restoring it in a scene created with the same Scene_Descriptor, on the same thread, continues the simulation bit-exactly.
+struct SceneSnapshot {
+    uint64_t                 steps_count{};
+    std::array<glm::vec2, 4> control_points{};
+    float                    pending_particles{}; // Of the emitter
+    rng::Generator::State    rng{};               // Of the thread that steps the scene
+
+    std::array<std::vector<float>, static_cast<size_t>(ParticleAttribute::COUNT)> attributes{}; // Of the alive particles, in the order of the pool
+};
+
+/// The particles, the curve that attracts them and the emitter that spawns them along it.
+/// Doesn't draw anything, so that it can also run headless. Random values are drawn from rng::thread_generator().
+class Scene {
+public:
+    explicit Scene(Scene_Descriptor desc);
+
+    Scene(Scene const&)                    = delete; // The emitter points to the curve and its arc lengths
+    auto operator=(Scene const&) -> Scene& = delete;
+    Scene(Scene&&)                         = delete;
+    auto operator=(Scene&&) -> Scene&      = delete;
+    ~Scene()                               = default;
+
+    /// Moves the curve according to the input
+    void apply(SceneInput const&);
+    /// apply()s the input, simulates the particles on the CPU, removes the expired ones and spawns the new ones
+    void step(SceneInput const&, float dt);
+
+    /// Must be called between two steps, from the thread that steps the scene
+    auto snapshot() const -> SceneSnapshot;
+    /// Fast-forwards (or rewinds) to the snapshot, without simulating the steps in between. Throws if the particles don't fit in the pool.
+    void restore(SceneSnapshot const&);
+
+    auto particles() -> ParticlePool& { return _particles; }
+    auto particles() const -> ParticlePool const& { return _particles; }
+    auto curve() const -> Curve const& { return _curve; }
+    auto emitter() -> Emitter& { return _emitter; }
+    auto obstacles() const -> std::vector<Segment> const& { return _obstacles; }
+    auto simulation_parameters() const -> simulation::Parameters const& { return _simulation_parameters; }
+    /// Number of calls to step() since the creation of the scene
+    auto steps_count() const -> uint64_t { return _steps_count; }
+
+private:
+    ParticlePool           _particles;
+    Curve                  _curve;
+    ArcLengthTable         _arc_lengths{};
+    Emitter                _emitter;
+    std::vector<Segment>   _obstacles;
+    simulation::Parameters _simulation_parameters; // Its obstacles point to _obstacles
+    simulation::Scratch    _scratch{};
+    uint64_t               _steps_count{0};
+};
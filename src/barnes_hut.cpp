@@ -0,0 +1,261 @@
+#include "barnes_hut.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <future>
+#include "parallel.hpp"
+
+namespace barnes_hut {
+
+static constexpr int    max_depth     = 16; // Morton codes use 16 bits per axis
+static constexpr size_t leaf_capacity = 8;  // Bodies of a leaf are processed with a plain (vectorizable) loop
+
+namespace {
+struct BuildContext {
+    std::span<uint32_t const> codes;
+    std::span<float const>    xs;
+    std::span<float const>    ys;
+    std::span<float const>    masses;
+    int                       parallel_depth; // Subtrees above this depth are built on separate threads
+};
+} // namespace
+
+/// Inserts a 0 bit between each of the 16 low bits of v
+static auto spread_bits(uint32_t v) -> uint32_t
+{
+    v &= 0x0000ffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+/// LSD radix sort of the codes, carrying the indices along. 4 passes of 8 bits.
+static void radix_sort(std::vector<uint32_t>& codes, std::vector<uint32_t>& indices)
+{
+    std::vector<uint32_t> codes_tmp(codes.size());
+    std::vector<uint32_t> indices_tmp(indices.size());
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        std::array<size_t, 257> offsets{};
+        for (uint32_t const code : codes)
+            offsets[((code >> shift) & 0xff) + 1]++;
+        for (size_t i = 1; i < offsets.size(); ++i)
+            offsets[i] += offsets[i - 1];
+        for (size_t i = 0; i < codes.size(); ++i)
+        {
+            size_t const dst = offsets[(codes[i] >> shift) & 0xff]++;
+            codes_tmp[dst]   = codes[i];
+            indices_tmp[dst] = indices[i];
+        }
+        codes.swap(codes_tmp);
+        indices.swap(indices_tmp);
+    }
+}
+
+static void build_subtree(BuildContext const& ctx, uint32_t begin, uint32_t end, int level, glm::vec2 origin, float size, std::vector<Node>& out) // NOLINT(*-no-recursion)
+{
+    size_t const node_index = out.size();
+    out.push_back(Node{.size = size, .first_body = begin});
+
+    if (end - begin <= leaf_capacity || level == max_depth)
+    {
+        float mass{0.f};
+        float x{0.f};
+        float y{0.f};
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            mass += ctx.masses[i];
+            x += ctx.masses[i] * ctx.xs[i];
+            y += ctx.masses[i] * ctx.ys[i];
+        }
+        auto& node          = out[node_index];
+        node.mass           = mass;
+        node.center_of_mass = mass > 0.f ? glm::vec2{x, y} / mass : origin + size / 2.f;
+        node.bodies_count   = end - begin;
+        node.next           = static_cast<uint32_t>(out.size());
+        return;
+    }
+
+    // All the codes in [begin, end) share the same prefix, so the 2 bits that select the child are sorted too.
+    int const               shift = 2 * (max_depth - 1 - level);
+    std::array<uint32_t, 5> bounds{begin, 0, 0, 0, end};
+    for (uint32_t c = 1; c < 4; ++c)
+    {
+        auto const it = std::partition_point(ctx.codes.begin() + bounds[c - 1], ctx.codes.begin() + end, [&](uint32_t code) {
+            return ((code >> shift) & 3u) < c;
+        });
+        bounds[c] = static_cast<uint32_t>(it - ctx.codes.begin());
+    }
+    float const half_size    = size / 2.f;
+    auto const  child_origin = [&](uint32_t c) {
+        return origin + half_size * glm::vec2{static_cast<float>(c & 1u), static_cast<float>(c >> 1u)};
+    };
+
+    if (level < ctx.parallel_depth)
+    {
+        std::array<std::vector<Node>, 4> children{};
+        std::array<std::future<void>, 4> tasks{};
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            if (bounds[c] != bounds[c + 1])
+            {
+                tasks[c] = std::async(std::launch::async, [&, c]() {
+                    build_subtree(ctx, bounds[c], bounds[c + 1], level + 1, child_origin(c), half_size, children[c]);
+                });
+            }
+        }
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            if (!tasks[c].valid())
+                continue;
+            tasks[c].get();
+            auto const offset = static_cast<uint32_t>(out.size());
+            for (Node node : children[c])
+            {
+                node.next += offset;
+                out.push_back(node);
+            }
+        }
+    }
+    else
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            if (bounds[c] != bounds[c + 1])
+                build_subtree(ctx, bounds[c], bounds[c + 1], level + 1, child_origin(c), half_size, out);
+        }
+    }
+
+    // Combine the direct children
+    float     mass{0.f};
+    glm::vec2 weighted_position{0.f};
+    for (size_t i = node_index + 1; i < out.size(); i = out[i].next)
+    {
+        mass += out[i].mass;
+        weighted_position += out[i].mass * out[i].center_of_mass;
+    }
+    auto& node          = out[node_index];
+    node.mass           = mass;
+    node.center_of_mass = mass > 0.f ? weighted_position / mass : origin + half_size;
+    node.next           = static_cast<uint32_t>(out.size());
+}
+
+void QuadTree::build(std::span<float const> xs, std::span<float const> ys, std::span<float const> masses)
+{
+    assert(xs.size() == ys.size() && xs.size() == masses.size());
+    _nodes.clear();
+    size_t const bodies_count = xs.size();
+    if (bodies_count == 0)
+        return;
+
+    // Square bounding box
+    glm::vec2 min{xs[0], ys[0]};
+    glm::vec2 max{min};
+    for (size_t i = 0; i < bodies_count; ++i)
+    {
+        min = glm::min(min, glm::vec2{xs[i], ys[i]});
+        max = glm::max(max, glm::vec2{xs[i], ys[i]});
+    }
+    float const size = std::max(max.x - min.x, max.y - min.y) * 1.0001f + 1e-6f; // Slightly bigger so that the max lands in the last cell, not out of the grid
+
+    // Morton codes
+    _codes.resize(bodies_count);
+    std::vector<uint32_t> indices(bodies_count);
+    parallel::for_each_chunk(bodies_count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto const cell = glm::clamp((glm::vec2{xs[i], ys[i]} - min) / size * 65536.f, glm::vec2{0.f}, glm::vec2{65535.f});
+            _codes[i]       = spread_bits(static_cast<uint32_t>(cell.x)) | (spread_bits(static_cast<uint32_t>(cell.y)) << 1);
+            indices[i]      = static_cast<uint32_t>(i);
+        }
+    });
+    radix_sort(_codes, indices);
+
+    // Bodies in Morton order
+    _xs.resize(bodies_count);
+    _ys.resize(bodies_count);
+    _masses.resize(bodies_count);
+    parallel::for_each_chunk(bodies_count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            _xs[i]     = xs[indices[i]];
+            _ys[i]     = ys[indices[i]];
+            _masses[i] = masses[indices[i]];
+        }
+    });
+
+    auto const ctx = BuildContext{
+        .codes          = _codes,
+        .xs             = _xs,
+        .ys             = _ys,
+        .masses         = _masses,
+        .parallel_depth = bodies_count > 16384 ? 2 : 0, // Up to 16 subtrees built concurrently
+    };
+    build_subtree(ctx, 0, static_cast<uint32_t>(bodies_count), 0, min, size, _nodes);
+}
+
+glm::vec2 QuadTree::acceleration(glm::vec2 position, Parameters const& params) const
+{
+    float const theta_squared     = params.theta * params.theta;
+    float const softening_squared = params.softening * params.softening;
+
+    float        ax{0.f};
+    float        ay{0.f};
+    size_t       i           = 0;
+    size_t const nodes_count = _nodes.size();
+    while (i < nodes_count)
+    {
+        Node const& node = _nodes[i];
+        if (node.bodies_count != 0)
+        {
+            // Leaf: exact interactions. Plain loop over contiguous arrays so that the compiler can vectorize it.
+            uint32_t const end = node.first_body + node.bodies_count;
+            for (uint32_t b = node.first_body; b < end; ++b)
+            {
+                float const dx    = _xs[b] - position.x;
+                float const dy    = _ys[b] - position.y;
+                float const r2    = dx * dx + dy * dy + softening_squared;
+                float const inv_r = 1.f / std::sqrt(r2);
+                float const f     = _masses[b] * inv_r * inv_r * inv_r;
+                ax += f * dx;
+                ay += f * dy;
+            }
+            i = node.next;
+            continue;
+        }
+
+        glm::vec2 const d  = node.center_of_mass - position;
+        float const     r2 = glm::dot(d, d);
+        if (node.size * node.size < theta_squared * r2)
+        {
+            // Far enough: the whole cell acts as a single body
+            float const inv_r = 1.f / std::sqrt(r2 + softening_squared);
+            float const f     = node.mass * inv_r * inv_r * inv_r;
+            ax += f * d.x;
+            ay += f * d.y;
+            i = node.next;
+        }
+        else
+        {
+            ++i; // Open the cell
+        }
+    }
+    return params.gravitational_constant * glm::vec2{ax, ay};
+}
+
+void QuadTree::accumulate_accelerations(std::span<float const> xs, std::span<float const> ys, std::span<float> ax, std::span<float> ay, Parameters const& params) const
+{
+    assert(xs.size() == ys.size() && xs.size() == ax.size() && xs.size() == ay.size());
+    parallel::for_each_chunk(xs.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            glm::vec2 const acc = acceleration({xs[i], ys[i]}, params);
+            ax[i] += acc.x;
+            ay[i] += acc.y;
+        }
+    }, 256);
+}
+
+} // namespace barnes_hut
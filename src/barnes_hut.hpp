@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "glm/glm.hpp"
+
+namespace barnes_hut {
+
+struct Parameters {
+    float theta{0.5f};                    // Opening angle: a cell is seen as a single body when its size / distance is below theta. 0 gives the exact O(N²) result.
+    float gravitational_constant{0.001f}; // G in a = G * m / r², with r in the units of the positions (the window is 2 units high)
+    float softening{0.02f};               // Avoids infinite forces when two bodies get very close
+};
+
+/// Nodes are stored in depth-first order, so the first child of a node is always the next node in the array,
+/// and `next` is the index of the first node after the whole subtree. This allows a stackless traversal:
+/// opening a cell means going to `index + 1`, accepting it (or finishing a leaf) means jumping to `next`.
+struct Node {
+    glm::vec2 center_of_mass{};
+    float     mass{};
+    float     size{};         // Side of the square cell
+    uint32_t  next{};         // Skip pointer
+    uint32_t  first_body{};   // Bodies of a leaf are stored contiguously in the tree's sorted arrays
+    uint32_t  bodies_count{}; // 0 for internal nodes
+};
+
+class QuadTree {
+public:
+    /// Builds the tree from SoA positions and masses. All spans must have the same size.
+    void build(std::span<float const> xs, std::span<float const> ys, std::span<float const> masses);
+
+    /// Gravitational acceleration created by all the bodies of the tree at the given position.
+    glm::vec2 acceleration(glm::vec2 position, Parameters const&) const;
+
+    /// Adds the acceleration felt by each body to `ax` and `ay`. Runs on several threads.
+    void accumulate_accelerations(std::span<float const> xs, std::span<float const> ys, std::span<float> ax, std::span<float> ay, Parameters const&) const;
+
+    auto nodes() const -> std::vector<Node> const& { return _nodes; }
+
+private:
+    std::vector<Node>     _nodes{};
+    std::vector<uint32_t> _codes{};  // Morton codes, sorted
+    std::vector<float>    _xs{};     // Positions and masses of the bodies,
+    std::vector<float>    _ys{};     // sorted in Morton order so that each leaf
+    std::vector<float>    _masses{}; // references a contiguous range.
+};
+
+} // namespace barnes_hut
@@ -0,0 +1,259 @@
+#include "bezier.hpp"
+#include <array>
+#include <cassert>
+#include <vector>
+
+glm::vec2 bezier3(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t)
+{
+    glm::vec2 a = glm::mix(p0, p1, t);
+    glm::vec2 b = glm::mix(p1, p2, t);
+    glm::vec2 c = glm::mix(p2, p3, t);
+
+    glm::vec2 d = glm::mix(a, b, t);
+    glm::vec2 e = glm::mix(b, c, t);
+
+    glm::vec2 f = glm::mix(d, e, t);
+
+    return f;
+}
+
+glm::vec2 bezier1_casteljau(glm::vec2 p0, glm::vec2 p1, float t)
+{
+    return glm::mix(p0, p1, t);
+}
+glm::vec2 bezier2_casteljau(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, float t)
+{
+    glm::vec2 a = glm::mix(p0, p1, t);
+    glm::vec2 b = glm::mix(p1, p2, t);
+    return glm::mix(a, b, t);
+}
+glm::vec2 bezier3_casteljau(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t)
+{
+    glm::vec2 a = glm::mix(p0, p1, t);
+    glm::vec2 b = glm::mix(p1, p2, t);
+    glm::vec2 c = glm::mix(p2, p3, t);
+
+    glm::vec2 d = glm::mix(a, b, t);
+    glm::vec2 e = glm::mix(b, c, t);
+
+    return glm::mix(d, e, t);
+}
+glm::vec2 bezier1_bernstein(glm::vec2 p0, glm::vec2 p1, float t)
+{
+    return (1 - t) * p0 + t * p1;
+}
+glm::vec2 bezier2_bernstein(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, float t)
+{
+    float u = 1 - t;
+    return u*u * p0 + 2*u*t * p1 + t*t * p2;
+}
+glm::vec2 bezier3_bernstein(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t)
+{
+    float u = 1 - t;
+    float uu = u * u;
+    float tt = t * t;
+
+    return uu * u * p0
+         + 3 * uu * t * p1
+         + 3 * u * tt * p2
+         + tt * t * p3;
+}
+float find_closest_t_on_bezier3(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::vec2 Q)
+{
+    float t = 0.5f;
+    float learning_rate = 0.01f;
+    int max_iterations = 100;
+
+    for (int i = 0; i < max_iterations; ++i)
+    {
+        float dt = 0.001f;
+
+        glm::vec2 B1 = bezier3_bernstein(p0, p1, p2, p3, t);
+        glm::vec2 B2 = bezier3_bernstein(p0, p1, p2, p3, t + dt);
+
+        float d1 = glm::dot(B1 - Q, B1 - Q);
+        float d2 = glm::dot(B2 - Q, B2 - Q);
+
+        float gradient = (d2 - d1) / dt;
+
+        t -= learning_rate * gradient;
+        t = glm::clamp(t, 0.0f, 1.0f);
+    }
+
+    return t;
+}
+
+static constexpr size_t max_batched_degree = 15;
+
+/// Coefficients of the curve in the power basis: B(t) = sum of coefficients[k] * t^k
+struct PowerBasis {
+    size_t                                         degree{};
+    std::array<glm::dvec2, max_batched_degree + 1> coefficients{};
+};
+
+auto binomial(size_t n, size_t k) -> double
+{
+    double result = 1.;
+    for (size_t i = 1; i <= k; ++i)
+        result = result * static_cast<double>(n - k + i) / static_cast<double>(i);
+    return result;
+}
+
+/// k-th coefficient of the curve in the power basis
+static auto power_basis_coefficient(std::span<glm::vec2 const> control_points, size_t k) -> glm::dvec2
+{
+    size_t const degree = control_points.size() - 1;
+    glm::dvec2   sum{0.};
+    for (size_t i = 0; i <= k; ++i)
+        sum += ((k - i) % 2 == 0 ? 1. : -1.) * binomial(k, i) * glm::dvec2{control_points[i]};
+    return binomial(degree, k) * sum;
+}
+
+static auto fits_in_power_basis(std::span<glm::vec2 const> control_points) -> bool
+{
+    return control_points.size() <= max_batched_degree + 1;
+}
+
+static auto to_power_basis(std::span<glm::vec2 const> control_points) -> PowerBasis
+{
+    assert(!control_points.empty() && fits_in_power_basis(control_points));
+    auto res   = PowerBasis{};
+    res.degree = control_points.size() - 1;
+    for (size_t k = 0; k <= res.degree; ++k)
+        res.coefficients[k] = power_basis_coefficient(control_points, k);
+    return res;
+}
+
+void bezier_to_power_basis(std::span<glm::vec2 const> control_points, std::span<glm::vec2> coefficients)
+{
+    assert(control_points.size() == coefficients.size());
+    for (size_t k = 0; k < control_points.size(); ++k)
+        coefficients[k] = power_basis_coefficient(control_points, k);
+}
+
+static auto evaluate(PowerBasis const& basis, double t) -> glm::dvec2
+{
+    glm::dvec2 res = basis.coefficients[basis.degree];
+    for (size_t k = basis.degree; k-- > 0;)
+        res = res * t + basis.coefficients[k];
+    return res;
+}
+
+/// For the curves whose degree is too high for PowerBasis. Slower, but works for any degree.
+static auto evaluate_casteljau(std::span<glm::vec2 const> control_points, float t, std::vector<glm::vec2>& points) -> glm::vec2
+{
+    points.assign(control_points.begin(), control_points.end());
+    for (size_t n = points.size() - 1; n > 0; --n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            points[i] = glm::mix(points[i], points[i + 1], t);
+    }
+    return points[0];
+}
+
+void bezier_evaluate_uniform(std::span<glm::vec2 const> control_points, std::span<glm::vec2> out)
+{
+    if (out.empty())
+        return;
+    if (!fits_in_power_basis(control_points))
+    {
+        std::vector<glm::vec2> points{};
+        for (size_t i = 0; i < out.size(); ++i)
+            out[i] = evaluate_casteljau(control_points, out.size() == 1 ? 0.f : static_cast<float>(i) / static_cast<float>(out.size() - 1), points);
+        return;
+    }
+    auto const basis = to_power_basis(control_points);
+    if (out.size() == 1)
+    {
+        out[0] = evaluate(basis, 0.);
+        return;
+    }
+
+    // Initial forward differences, computed exactly from the power basis instead of by subtracting samples, which would lose precision.
+    // The k-th difference of t^j with step h, at t = 0, is h^j * k! * S(j, k), where S are the Stirling numbers of the second kind.
+    double const                                   step = 1. / static_cast<double>(out.size() - 1);
+    std::array<glm::dvec2, max_batched_degree + 1> differences{};
+    std::array<double, max_batched_degree + 1>     stirling{1.}; // Row j of the table: S(j, 0..j)
+    double                                         step_power = 1.;
+    for (size_t j = 0; j <= basis.degree; ++j)
+    {
+        if (j > 0)
+        {
+            for (size_t k = j; k >= 1; --k)
+                stirling[k] = static_cast<double>(k) * stirling[k] + stirling[k - 1];
+            stirling[0] = 0.;
+            step_power *= step;
+        }
+        double factorial = 1.;
+        for (size_t k = 0; k <= j; ++k)
+        {
+            if (k > 0)
+                factorial *= static_cast<double>(k);
+            differences[k] += basis.coefficients[j] * (step_power * factorial * stirling[k]);
+        }
+    }
+
+    for (glm::vec2& point : out)
+    {
+        point = differences[0];
+        for (size_t k = 0; k < basis.degree; ++k)
+            differences[k] += differences[k + 1];
+    }
+}
+
+/// The degree is a template parameter so that the inner loop is unrolled, and the loop over the parameters can be vectorized.
+template<size_t Degree>
+static void evaluate_horner(PowerBasis const& basis, std::span<float const> ts, std::span<float> xs, std::span<float> ys)
+{
+    std::array<float, Degree + 1> cx{};
+    std::array<float, Degree + 1> cy{};
+    for (size_t k = 0; k <= Degree; ++k)
+    {
+        cx[k] = static_cast<float>(basis.coefficients[k].x);
+        cy[k] = static_cast<float>(basis.coefficients[k].y);
+    }
+    for (size_t i = 0; i < ts.size(); ++i)
+    {
+        float const t = ts[i];
+        float       x = cx[Degree];
+        float       y = cy[Degree];
+        for (size_t k = Degree; k-- > 0;)
+        {
+            x = x * t + cx[k];
+            y = y * t + cy[k];
+        }
+        xs[i] = x;
+        ys[i] = y;
+    }
+}
+
+void bezier_evaluate(std::span<glm::vec2 const> control_points, std::span<float const> ts, std::span<float> xs, std::span<float> ys)
+{
+    assert(ts.size() == xs.size() && ts.size() == ys.size());
+    if (!fits_in_power_basis(control_points))
+    {
+        std::vector<glm::vec2> points{};
+        for (size_t i = 0; i < ts.size(); ++i)
+        {
+            glm::vec2 const p = evaluate_casteljau(control_points, ts[i], points);
+            xs[i]             = p.x;
+            ys[i]             = p.y;
+        }
+        return;
+    }
+    auto const basis = to_power_basis(control_points);
+    switch (basis.degree)
+    {
+    case 0: return evaluate_horner<0>(basis, ts, xs, ys);
+    case 1: return evaluate_horner<1>(basis, ts, xs, ys);
+    case 2: return evaluate_horner<2>(basis, ts, xs, ys);
+    case 3: return evaluate_horner<3>(basis, ts, xs, ys);
+    default:
+        for (size_t i = 0; i < ts.size(); ++i)
+        {
+            glm::vec2 const p = evaluate(basis, static_cast<double>(ts[i]));
+            xs[i]             = p.x;
+            ys[i]             = p.y;
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <span>
+#include "glm/glm.hpp"
+
+glm::vec2 bezier3(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t);
+
+glm::vec2 bezier1_casteljau(glm::vec2 p0, glm::vec2 p1, float t);
+glm::vec2 bezier2_casteljau(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, float t);
+glm::vec2 bezier3_casteljau(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t);
+
+glm::vec2 bezier1_bernstein(glm::vec2 p0, glm::vec2 p1, float t);
+glm::vec2 bezier2_bernstein(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, float t);
+glm::vec2 bezier3_bernstein(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t);
+
+float find_closest_t_on_bezier3(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::vec2 Q);
+
+// Batched evaluation, for any degree (the degree is control_points.size() - 1).
+// Up to degree 15 the curve is converted to the power basis. Above that, each point is evaluated with de Casteljau's algorithm, which is a lot slower.
+
+/// Evaluates the curve at `out.size()` uniformly spaced parameters, from t = 0 to t = 1 included.
+/// Uses forward differencing: after the setup, each point only costs `degree` additions.
+void bezier_evaluate_uniform(std::span<glm::vec2 const> control_points, std::span<glm::vec2> out);
+/// Evaluates the curve at arbitrary parameters, and writes the result as SoA.
+/// `ts` can alias `xs` or `ys`: each parameter is read before its result is written.
+void bezier_evaluate(std::span<glm::vec2 const> control_points, std::span<float const> ts, std::span<float> xs, std::span<float> ys);
+
+/// Coefficients of the curve in the power basis: B(t) = sum of coefficients[k] * t^k. Both spans must have the same size.
+void bezier_to_power_basis(std::span<glm::vec2 const> control_points, std::span<glm::vec2> coefficients);
+
+/// "n choose k", the coefficients of the Bernstein polynomials. A double, so that it doesn't overflow for high degrees.
+auto binomial(size_t n, size_t k) -> double;
@@ -0,0 +1,121 @@
+#pragma once
+#include <cmath>
+#include <span>
+
+/// Easing functions, mapping [0, 1] to [0, 1] with f(0) = 0 and f(1) = 1.
+/// The exponents are template parameters, so that `in_out<3>` compiles to a few multiplications instead of a call to pow.
+namespace easing {
+
+/// x^N, by repeated squaring at compile time
+template<unsigned N>
+constexpr auto power(float x) -> float
+{
+    if constexpr (N == 0)
+        return 1.f;
+    else if constexpr (N % 2 == 0)
+        return power<N / 2>(x * x);
+    else
+        return x * power<N - 1>(x);
+}
+
+constexpr auto linear(float x) -> float
+{
+    return x;
+}
+
+template<unsigned N>
+constexpr auto in(float x) -> float
+{
+    return power<N>(x);
+}
+
+template<unsigned N>
+constexpr auto out(float x) -> float
+{
+    return 1.f - power<N>(1.f - x);
+}
+
+template<unsigned N>
+constexpr auto in_out(float x) -> float
+{
+    return x < 0.5f
+               ? 0.5f * power<N>(2.f * x)
+               : 1.f - 0.5f * power<N>(2.f * (1.f - x));
+}
+
+constexpr auto smoothstep(float x) -> float
+{
+    return x * x * (3.f - 2.f * x);
+}
+
+constexpr auto smootherstep(float x) -> float
+{
+    return x * x * x * (x * (6.f * x - 15.f) + 10.f);
+}
+
+/// Overshoots below 0 before accelerating
+constexpr auto back_in(float x) -> float
+{
+    constexpr float c = 1.70158f;
+    return x * x * ((c + 1.f) * x - c);
+}
+
+/// Overshoots above 1 before settling
+constexpr auto back_out(float x) -> float
+{
+    return 1.f - back_in(1.f - x);
+}
+
+inline auto sine_in(float x) -> float
+{
+    return 1.f - std::cos(x * 1.5707963f);
+}
+
+inline auto sine_out(float x) -> float
+{
+    return std::sin(x * 1.5707963f);
+}
+
+inline auto sine_in_out(float x) -> float
+{
+    return 0.5f - 0.5f * std::cos(x * 3.1415927f);
+}
+
+inline auto exponential_in(float x) -> float
+{
+    return x <= 0.f ? 0.f : std::exp2(10.f * x - 10.f);
+}
+
+inline auto exponential_out(float x) -> float
+{
+    return x >= 1.f ? 1.f : 1.f - std::exp2(-10.f * x);
+}
+
+inline auto circular_in(float x) -> float
+{
+    return 1.f - std::sqrt(1.f - x * x);
+}
+
+inline auto circular_out(float x) -> float
+{
+    return std::sqrt((2.f - x) * x);
+}
+
+/// Applies the easing to each value, in place: `easing::apply<easing::in_out<3>>(values)`.
+/// Taking the function as a template parameter lets the compiler inline it in the loop.
+template<auto Easing>
+void apply(std::span<float> values)
+{
+    for (float& value : values)
+        value = Easing(value);
+}
+
+/// Writes the easing of each input in the output, which must have the same size
+template<auto Easing>
+void apply(std::span<float const> in, std::span<float> out)
+{
+    for (size_t i = 0; i < in.size(); ++i)
+        out[i] = Easing(in[i]);
+}
+
+} // namespace easing
@@ -0,0 +1,24 @@
+#pragma once
+#include "glm/glm.hpp"
+
+/// Force model of the particles. GpuParticleSystem implements the same one in its compute shader: keep them in sync.
+namespace forces {
+
+struct Parameters {
+    glm::vec2 gravity{0.f, 0.f};     // Acceleration, the same for all particles
+    float     air_friction{0.f};     // Force opposed to the velocity: -air_friction * velocity
+    float     curve_attraction{4.f}; // Force towards the closest point of the curve: curve_attraction / (curve_attraction + distance), so it weakens with the distance
+};
+
+/// `to_curve` goes from the particle to the closest point of the curve
+inline auto acceleration(Parameters const& params, glm::vec2 velocity, float mass, glm::vec2 to_curve) -> glm::vec2
+{
+    float const     distance  = glm::length(to_curve);
+    glm::vec2 const direction = distance > 0.f ? to_curve / distance : glm::vec2{0.f};
+
+    glm::vec2 const force = params.curve_attraction / (params.curve_attraction + distance) * direction
+                          - params.air_friction * velocity;
+    return params.gravity + force / mass;
+}
+
+} // namespace forces
@@ -1,130 +1,28 @@
+#include <iostream>
+#include <string_view>
 #include "glm/ext/scalar_constants.hpp"
+#include "Curve.hpp"
+#include "GpuParticleSystem.hpp"
+#include "Gradient.hpp"
+#include "ParticlePool.hpp"
+#include "Scene.hpp"
+#include "bezier.hpp"
+#include "easing.hpp"
 #include "opengl-framework/opengl-framework.hpp"
+#include "recording.hpp"
+#include "segments.hpp"
 #include "utils.hpp"
 
-struct IntersectionResult {
-    glm::vec2 point;
-    float t, s;
-};
+static constexpr float particle_radius = 0.015f;
 
-std::optional<IntersectionResult> intersect_segments(const glm::vec2& A, const glm::vec2& B,
-                                                     const glm::vec2& C, const glm::vec2& D)
+void draw_polyline(std::span<glm::vec2 const> points)
 {
-    glm::vec2 u = B - A;
-    glm::vec2 v = D - C;
-    glm::vec2 w = C - A;
-    // Matrice M = [u, -v]
-    glm::mat2 M(u, -v);
-    float det = glm::determinant(M);
-
-    if (glm::abs(det) < 1e-6f)
-        return std::nullopt;  // Parallèles ou colinéaires
-
-    glm::mat2 invM = glm::inverse(M);
-    glm::vec2 ts = invM * w;
-    float t = ts.x;
-    float s = ts.y;
-
-    if (t >= 0.0f && t <= 1.0f && s >= 0.0f && s <= 1.0f) {
-        glm::vec2 P = A + t * u;
-        return IntersectionResult{P, t, s};
-    }
-
-    return std::nullopt;
-}
-
-
-float easeInOut(float x, float power)
-{
-    if (x < 0.5)
-    {
-        return 0.5 * pow(2 * x, power);
-    }
-    else
-    {
-        return 1 - 0.5 * pow(2 * (1 - x), power);
-    }
-}
-
-struct Particle {
-    glm::vec2 position{
-        utils::rand(-gl::window_aspect_ratio(), +gl::window_aspect_ratio()),
-        utils::rand(-1.f, +1.f),
-    };
-
-    glm::vec2 velocity;
-
-    float mass{utils::rand(1.f, 2.f)};
-
-    float age{0.f};
-    float lifespan{utils::rand(5.f, 15.f)};
-
-    glm::vec3 start_color{
-        utils::rand(0.f, 1.f),
-        utils::rand(0.f, 1.f),
-        utils::rand(0.f, 1.f),
-    };
-    glm::vec3 end_color{
-        utils::rand(0.f, 1.f),
-        utils::rand(0.f, 1.f),
-        utils::rand(0.f, 1.f),
-    };
-
-    glm::vec3 color() const
-    {
-        return start_color;
-    }
-
-    float radius() const
-    {
-        return 0.015f;
-    }
-
-    float relative_age() const
-    {
-        return age / lifespan;
-    }
-
-    Particle()
-    {
-        float const initial_angle = utils::rand(0.f, 2.f * glm::pi<float>());
-
-        velocity = {
-            0.2f * std::cos(initial_angle),
-            0.2f * std::sin(initial_angle),
-        };
-    }
-};
-
-struct Segment
-{
-    glm::vec2 A;
-    glm::vec2 B;
-
-    glm::vec2 normal() const
-    {
-        glm::vec2 dir = B - A;
-        glm::vec2 n = glm::normalize(glm::vec2(-dir.y, dir.x)); // Perpendicular
-        return n;
-    }
-};
-glm::vec2 cacaprout(glm::vec2 origin, float radius)
-{
-    float x = utils::rand(-1.f, 1.f);
-    float y = utils::rand(-1.f, 1.f);
-    glm::vec2 offset = glm::vec2(x, y) * radius;
+    const float thickness = .01f;
+    const glm::vec4 color = {1.0f, 1.0f, 1.0f, 1.0f}; // blanc opaque
 
-    if (glm::length(offset) <= radius)
-    {
-        return origin + offset;
-    }
-    else
-    {
-        return cacaprout(origin, radius); // récursion si en dehors du cercle
-    }
+    utils::draw_polyline(points, thickness, color);
 }
 
-
 void draw_parametric(std::function<glm::vec2(float)> const& parametric)
 {
     const int N = 100; // nombre de segments
@@ -142,97 +40,64 @@ void draw_parametric(std::function<glm::vec2(float)> const& parametric)
     }
 }
 
-glm::vec2 bezier3(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t)
+void draw_curve(Curve const& curve)
 {
-    glm::vec2 a = glm::mix(p0, p1, t);
-    glm::vec2 b = glm::mix(p1, p2, t);
-    glm::vec2 c = glm::mix(p2, p3, t);
-
-    glm::vec2 d = glm::mix(a, b, t);
-    glm::vec2 e = glm::mix(b, c, t);
-
-    glm::vec2 f = glm::mix(d, e, t);
-
-    return f;
+    std::array<glm::vec2, 101> curve_points{}; // 100 segments
+    bezier_evaluate_uniform(curve.control_points(), curve_points);
+    draw_polyline(curve_points);
 }
 
-glm::vec2 bezier1_casteljau(glm::vec2 p0, glm::vec2 p1, float t)
+int main(int argc, char** argv)
 {
-    return glm::mix(p0, p1, t);
-}
-glm::vec2 bezier2_casteljau(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, float t)
-{
-    glm::vec2 a = glm::mix(p0, p1, t);
-    glm::vec2 b = glm::mix(p1, p2, t);
-    return glm::mix(a, b, t);
-}
-glm::vec2 bezier3_casteljau(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t)
-{
-    glm::vec2 a = glm::mix(p0, p1, t);
-    glm::vec2 b = glm::mix(p1, p2, t);
-    glm::vec2 c = glm::mix(p2, p3, t);
-
-    glm::vec2 d = glm::mix(a, b, t);
-    glm::vec2 e = glm::mix(b, c, t);
-
-    return glm::mix(d, e, t);
-}
-glm::vec2 bezier1_bernstein(glm::vec2 p0, glm::vec2 p1, float t)
-{
-    return (1 - t) * p0 + t * p1;
-}
-glm::vec2 bezier2_bernstein(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, float t)
-{
-    float u = 1 - t;
-    return u*u * p0 + 2*u*t * p1 + t*t * p2;
-}
-glm::vec2 bezier3_bernstein(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t)
-{
-    float u = 1 - t;
-    float uu = u * u;
-    float tt = t * t;
-
-    return uu * u * p0
-         + 3 * uu * t * p1
-         + 3 * u * tt * p2
-         + tt * t * p3;
-}
-float find_closest_t_on_bezier3(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::vec2 Q)
-{
-    float t = 0.5f;
-    float learning_rate = 0.01f;
-    int max_iterations = 100;
-
-    for (int i = 0; i < max_iterations; ++i)
+    bool record_session = false;
+    bool profile        = false;
+    for (int i = 1; i < argc; ++i)
     {
-        float dt = 0.001f;
-
-        glm::vec2 B1 = bezier3_bernstein(p0, p1, p2, p3, t);
-        glm::vec2 B2 = bezier3_bernstein(p0, p1, p2, p3, t + dt);
-
-        float d1 = glm::dot(B1 - Q, B1 - Q);
-        float d2 = glm::dot(B2 - Q, B2 - Q);
-
-        float gradient = (d2 - d1) / dt;
-
-        t -= learning_rate * gradient;
-        t = glm::clamp(t, 0.0f, 1.0f);
+        std::string_view const argument{argv[i]}; // NOLINT(*pointer-arithmetic)
+        if (argument == "--record")
+            record_session = true;
+        else if (argument == "--profile")
+            profile = true;
     }
 
-    return t;
-}
-int main()
-{
     gl::init("Particules!");
     gl::maximize_window();
+    gl::profiler::set_enabled(profile); // With --profile, the last frames are saved to profile.json next to the executable when closing the window
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE);
 
-    std::vector<Particle> particles(50);
-    glm::vec2 p0 = {-0.6f, -0.6f};
-    glm::vec2 p1 = {-0.2f, 0.5f};
-    glm::vec2 p2 = gl::mouse_position(); // ou fixe-le une fois pour éviter les incohérences
-    glm::vec2 p3 = {0.8f, 0.5f};
+    // Continuously spawns particles along the curve, evenly spread over its length. The same scene runs headless in Particles_scenarios.
+    Scene         scene{{}};
+    ParticlePool& particles = scene.particles();
+
+    // Color over lifetime, shared by all the particles
+    Gradient const color_over_lifetime{{
+        {.position = 0.f, .color = {1.f, 0.85f, 0.4f, 1.f}},
+        {.position = 0.4f, .color = {1.f, 0.35f, 0.5f, 0.9f}},
+        {.position = 1.f, .color = {0.25f, 0.3f, 1.f, 0.f}},
+    }};
+    std::vector<float>     relative_age; // Eased, so that particles keep their first colors longer
+    std::vector<glm::vec4> colors;
+
+    std::vector<utils::DiskInstance> disk_instances;
+
+    // With --record, the inputs are recorded, with a snapshot every minute or so, in the recording folder next to the executable.
+    // Particles_scenarios --replay can then reproduce the session bit-exactly, starting from any of the snapshots.
+    static constexpr uint64_t   snapshot_interval = 3600; // In steps
+    std::filesystem::path const recording_folder  = gl::make_absolute_path(".") / "recording";
+    SceneRecording              recording{};
+
+    // Runs the simulation in a compute shader when available. The CPU pool is then only used as a staging area for the particles spawned each frame.
+    // Not when recording: the replay runs on the CPU, and can't reproduce the GPU rounding.
+    bool const                       use_gpu_simulation = !record_session;
+    std::optional<GpuParticleSystem> gpu_particles;
+    if (use_gpu_simulation && GpuParticleSystem::is_supported())
+        gpu_particles.emplace(100'000);
+
+    if (record_session)
+        std::cout << "Recording the session in " << recording_folder.string() << '\n';
+    else
+        std::cout << "Session recording is off, run with --record to be able to replay this session with Particles_scenarios\n";
 
     /*int N = static_cast<int>(particles.size());
     for (int i = 0; i < N; ++i)
@@ -266,20 +131,21 @@ int main()
         segments.push_back({A, B});
     }*/
 
-    for (auto& particle : particles)
     {
-        int N = static_cast<int>(particles.size());
-
-        for (int i = 0; i < N; ++i)
+        IndexRange const spawned = particles.spawn(50);
+        size_t const     N       = spawned.size();
+        for (size_t i = spawned.begin; i < spawned.end; ++i)
         {
             // x fixe à gauche, y réparti verticalement
-            float x = -0.9f;
-            float y = -1.f + 2.f * static_cast<float>(i) / (N - 1); // de -1 à +1
-
-            particles[i].position = glm::vec2(x, y);
+            particles.x()[i] = -0.9f;
+            particles.y()[i] = -1.f + 2.f * static_cast<float>(i) / static_cast<float>(N - 1); // de -1 à +1
 
             // Pas de vitesse initiale, ou vers le bas si tu veux tester sans champ de force
-            particles[i].velocity = glm::vec2(0.f, 0.f); // ou glm::vec2(0.f, -0.1f);
+            particles.vx()[i] = 0.f;
+            particles.vy()[i] = 0.f; // ou -0.1f
+
+            particles.mass()[i]     = utils::rand(1.f, 2.f);
+            particles.lifespan()[i] = utils::rand(5.f, 15.f);
         }
     }
 
@@ -288,35 +154,57 @@ int main()
         glClearColor(0.f, 0.f, 0.f, 1.f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        glm::vec2 p0 = {-0.6f, -0.6f};
-        glm::vec2 p1 = {-0.2f, 0.5f};
-        glm::vec2 p2 = gl::mouse_position(); // ou figé
-        glm::vec2 p3 = {0.8f, 0.5f};
-
-        draw_parametric([](float t) {
-    glm::vec2 p0 = {-0.6f, -0.6f};
-    glm::vec2 p1 = {-0.2f, 0.5f};
-    glm::vec2 p2 = gl::mouse_position(); // ou figé
-    glm::vec2 p3 = {0.8f, 0.5f};
-    return bezier3_bernstein(p0, p1, p2, p3, t);
-});
+        SceneInput const input{.mouse_position = gl::mouse_position()};
+        float const      dt = gl::delta_time_in_seconds();
 
-        for (auto& particle : particles)
+        if (gpu_particles)
         {
-            float t_closest = find_closest_t_on_bezier3(p0, p1, p2, p3, particle.position);
-            glm::vec2 P = bezier3_bernstein(p0, p1, p2, p3, t_closest);
-
-            glm::vec2 dir_to_curve = P - particle.position;
-            float dist = glm::length(dir_to_curve);
-            glm::vec2 dir_normale = dist > 0 ? dir_to_curve / dist : glm::vec2(0);
-
-            float strength = 4.0f / (4.0f + dist); // déclin doux
-            glm::vec2 force = strength * dir_normale;
+            scene.apply(input);
+            draw_curve(scene.curve());
+            gpu_particles->spawn(particles);
+            particles.clear();
+            {
+                gl::profiler::GpuScope const scope{"Update particles"};
+                auto const&                  control_points = scene.curve().control_points();
+                gpu_particles->update(dt, scene.simulation_parameters().forces, {control_points[0], control_points[1], control_points[2], control_points[3]});
+            }
+            {
+                gl::profiler::CpuScope const cpu_scope{"Draw particles"};
+                gl::profiler::GpuScope const gpu_scope{"Draw particles"};
+                gpu_particles->draw(color_over_lifetime, particle_radius);
+            }
+            scene.emitter().update(particles, dt);
+            continue;
+        }
 
-            glm::vec2 acceleration = force / particle.mass;
-            particle.velocity += acceleration * gl::delta_time_in_seconds();
-            particle.position += particle.velocity * gl::delta_time_in_seconds();
-            utils::draw_disk(particle.position, particle.radius(), glm::vec4{particle.color(), 1.f});
+        if (record_session)
+        {
+            if (scene.steps_count() % snapshot_interval == 0)
+            {
+                std::filesystem::create_directories(recording_folder);
+                save_snapshot(scene.snapshot(), recording_folder / ("snapshot_" + std::to_string(scene.steps_count()) + ".bin"));
+            }
+            recording.steps.push_back({.dt = dt, .input = input});
+        }
+        scene.step(input, dt);
+        draw_curve(scene.curve());
+
+        relative_age.resize(particles.size());
+        colors.resize(particles.size());
+        for (size_t i = 0; i < particles.size(); ++i)
+            relative_age[i] = particles.age()[i] / particles.lifespan()[i];
+        easing::apply<easing::in_out<3>>(relative_age);
+        color_over_lifetime.evaluate(relative_age, colors);
+
+        auto const x = particles.x();
+        auto const y = particles.y();
+        disk_instances.resize(particles.size());
+        for (size_t i = 0; i < particles.size(); ++i)
+            disk_instances[i] = utils::make_disk_instance({x[i], y[i]}, particle_radius, colors[i]);
+        {
+            gl::profiler::CpuScope const cpu_scope{"Draw particles"};
+            gl::profiler::GpuScope const gpu_scope{"Draw particles"};
+            utils::draw_disks(disk_instances);
         }
 
         /*draw_parametric([](float t) {
@@ -396,9 +284,6 @@ int main()
                 particle.position += particle.velocity * gl::delta_time_in_seconds();
             }*/
 
-            //std::erase_if(particles, [&](Particle const& particle) { return particle.age > particle.lifespan; });
-
-
             /*auto A = glm::vec2(-1, 0);
             auto B = glm::vec2(1, 0);
             auto C = glm::vec2(0, -0.75f);
@@ -415,4 +300,9 @@ int main()
         //utils::draw_line(glm::vec2(-1,0), glm::vec2(1,0), 0.01, glm::vec4{1.f, 0.f, 0.f, 1.f});
         //utils::draw_line(glm::vec2(0,-0.75), gl::mouse_position(), 0.01, glm::vec4{1.f, 1.f, 1.f, 1.f});
     }
+
+    if (profile)
+        gl::profiler::save_chrome_trace(gl::make_absolute_path(".") / "profile.json");
+    if (record_session)
+        save_recording(recording, recording_folder / "inputs.bin");
 }
@@ -0,0 +1,32 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+/// Splits [0, count) into contiguous chunks and calls `fn(begin, end)` on each of them, from several threads.
+/// Small workloads stay on the calling thread: spawning threads would cost more than it saves.
+template<typename Fn>
+void for_each_chunk(size_t count, Fn&& fn, size_t min_chunk_size = 4096)
+{
+    size_t const max_threads   = std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t const threads_count = std::clamp<size_t>(count / std::max<size_t>(min_chunk_size, 1), 1, max_threads);
+    if (threads_count == 1)
+    {
+        fn(size_t{0}, count);
+        return;
+    }
+
+    size_t const chunk_size = (count + threads_count - 1) / threads_count;
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(threads_count - 1);
+        for (size_t begin = chunk_size; begin < count; begin += chunk_size)
+            threads.emplace_back([&fn, begin, end = std::min(begin + chunk_size, count)]() { fn(begin, end); });
+        fn(size_t{0}, std::min(chunk_size, count)); // The calling thread takes its share of the work too
+    } // jthreads join here
+}
+
+} // namespace parallel
@@ -0,0 +1,148 @@
+#include "recording.hpp"
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+/// Must be incremented each time the content or layout of a file changes, so that old files are rejected instead of misread
+static constexpr uint32_t snapshot_version  = 1;
+static constexpr uint32_t recording_version = 1;
+
+static constexpr size_t attributes_count = static_cast<size_t>(ParticleAttribute::COUNT);
+
+namespace {
+
+struct SnapshotHeader {
+    std::array<char, 4>      magic{'P', 'S', 'N', 'P'};
+    uint32_t                 version{snapshot_version};
+    uint32_t                 attributes_count{::attributes_count}; // Snapshots saved before an attribute was added or removed can't be loaded
+    float                    pending_particles{};
+    uint64_t                 steps_count{};
+    uint64_t                 particles_count{};
+    std::array<glm::vec2, 4> control_points{};
+    rng::Generator::State    rng{};
+};
+
+struct RecordingHeader {
+    std::array<char, 4> magic{'P', 'R', 'E', 'C'};
+    uint32_t            version{recording_version};
+    uint64_t            steps_count{};
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader>);
+static_assert(std::is_trivially_copyable_v<RecordingHeader>);
+static_assert(std::is_trivially_copyable_v<SceneRecording::Step>);
+
+auto open_for_writing(std::filesystem::path const& path) -> std::ofstream
+{
+    auto file = std::ofstream{path, std::ios::binary};
+    if (!file)
+        throw std::runtime_error{"Failed to write " + path.string()};
+    return file;
+}
+
+auto open_for_reading(std::filesystem::path const& path) -> std::ifstream
+{
+    auto file = std::ifstream{path, std::ios::binary};
+    if (!file)
+        throw std::runtime_error{"Failed to open " + path.string()};
+    return file;
+}
+
+void write(std::ofstream& file, std::span<std::byte const> bytes)
+{
+    file.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size())); // NOLINT(*reinterpret-cast)
+}
+
+void read(std::ifstream& file, std::span<std::byte> bytes, std::filesystem::path const& path)
+{
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) // NOLINT(*reinterpret-cast)
+        throw std::runtime_error{path.string() + " is truncated"};
+}
+
+void check_header(std::array<char, 4> magic, std::array<char, 4> expected_magic, uint32_t version, uint32_t expected_version, std::filesystem::path const& path)
+{
+    if (magic != expected_magic)
+        throw std::runtime_error{path.string() + " is not a " + std::string{expected_magic.begin(), expected_magic.end()} + " file"};
+    if (version != expected_version)
+        throw std::runtime_error{path.string() + " has version " + std::to_string(version) + ", but only version " + std::to_string(expected_version) + " is supported"};
+}
+
+/// Before allocating anything, so that a corrupted count doesn't make us allocate gigabytes
+void check_size(std::filesystem::path const& path, uint64_t expected_size)
+{
+    if (std::filesystem::file_size(path) != expected_size)
+        throw std::runtime_error{path.string() + " is truncated or corrupted"};
+}
+
+} // namespace
+
+void save_snapshot(SceneSnapshot const& snapshot, std::filesystem::path const& path)
+{
+    SnapshotHeader const header{
+        .pending_particles = snapshot.pending_particles,
+        .steps_count       = snapshot.steps_count,
+        .particles_count   = snapshot.attributes[0].size(),
+        .control_points    = snapshot.control_points,
+        .rng               = snapshot.rng,
+    };
+
+    auto file = open_for_writing(path);
+    write(file, std::as_bytes(std::span{&header, 1}));
+    for (auto const& values : snapshot.attributes) // One array after the other, like in the pool
+        write(file, std::as_bytes(std::span{values}));
+    if (!file)
+        throw std::runtime_error{"Failed to write " + path.string()};
+}
+
+auto load_snapshot(std::filesystem::path const& path) -> SceneSnapshot
+{
+    auto           file = open_for_reading(path);
+    SnapshotHeader header{};
+    read(file, std::as_writable_bytes(std::span{&header, 1}), path);
+    check_header(header.magic, SnapshotHeader{}.magic, header.version, snapshot_version, path);
+    if (header.attributes_count != attributes_count)
+        throw std::runtime_error{path.string() + " has " + std::to_string(header.attributes_count) + " attributes per particle instead of " + std::to_string(attributes_count)};
+    check_size(path, sizeof(SnapshotHeader) + header.particles_count * attributes_count * sizeof(float));
+
+    SceneSnapshot snapshot{
+        .steps_count       = header.steps_count,
+        .control_points    = header.control_points,
+        .pending_particles = header.pending_particles,
+        .rng               = header.rng,
+    };
+    for (auto& values : snapshot.attributes)
+    {
+        values.resize(header.particles_count);
+        read(file, std::as_writable_bytes(std::span{values}), path);
+    }
+    return snapshot;
+}
+
+void save_recording(SceneRecording const& recording, std::filesystem::path const& path)
+{
+    RecordingHeader const header{.steps_count = recording.steps.size()};
+
+    auto file = open_for_writing(path);
+    write(file, std::as_bytes(std::span{&header, 1}));
+    write(file, std::as_bytes(std::span{recording.steps}));
+    if (!file)
+        throw std::runtime_error{"Failed to write " + path.string()};
+}
+
+auto load_recording(std::filesystem::path const& path) -> SceneRecording
+{
+    auto            file = open_for_reading(path);
+    RecordingHeader header{};
+    read(file, std::as_writable_bytes(std::span{&header, 1}), path);
+    check_header(header.magic, RecordingHeader{}.magic, header.version, recording_version, path);
+    check_size(path, sizeof(RecordingHeader) + header.steps_count * sizeof(SceneRecording::Step));
+
+    SceneRecording recording{};
+    recording.steps.resize(header.steps_count);
+    read(file, std::as_writable_bytes(std::span{recording.steps}), path);
+    return recording;
+}
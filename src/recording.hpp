@@ -0,0 +1,22 @@
+#pragma once
+#include <filesystem>
+#include <vector>
+#include "Scene.hpp"
+
+/// The inputs of a session, to replay it. Replaying the steps from a snapshot of step N on gives exactly the same particles as the original session.
+struct SceneRecording {
+    struct Step {
+        float      dt{};
+        SceneInput input{};
+    };
+    std::vector<Step> steps{}; // steps[i] is the input of the i-th step of the scene
+};
+
+// Binary files, in the byte order of the machine that wrote them.
+// Saving throws if the file can't be written. Loading throws if the file is missing, truncated, or was written by an incompatible version.
+
+void save_snapshot(SceneSnapshot const&, std::filesystem::path const&);
+auto load_snapshot(std::filesystem::path const&) -> SceneSnapshot;
+
+void save_recording(SceneRecording const&, std::filesystem::path const&);
+auto load_recording(std::filesystem::path const&) -> SceneRecording;
@@ -0,0 +1,145 @@
+#include "rng.hpp"
+#include <algorithm>
+#include <atomic>
+#include <random>
+
+namespace rng {
+
+static auto splitmix64(uint64_t& state) -> uint64_t
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z          = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+static auto rotl(uint32_t x, int k) -> uint32_t
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+/// Keeps the 24 high bits (the best ones of xoshiro128+), which is all the precision a float in [0, 1) can hold
+static auto to_unit_float(uint32_t x) -> float
+{
+    return static_cast<float>(x >> 8) * 0x1.0p-24f;
+}
+
+Generator::Generator(uint64_t seed, uint64_t stream)
+{
+    uint64_t state = seed ^ splitmix64(stream);
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+        uint64_t const a = splitmix64(state);
+        uint64_t const b = splitmix64(state);
+        _s0[lane]        = static_cast<uint32_t>(a);
+        _s1[lane]        = static_cast<uint32_t>(a >> 32);
+        _s2[lane]        = static_cast<uint32_t>(b);
+        _s3[lane]        = static_cast<uint32_t>(b >> 32) | 1u; // The state must never be all zeros
+    }
+}
+
+void Generator::next_block(std::array<uint32_t, lanes>& out)
+{
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+        out[lane]        = _s0[lane] + _s3[lane];
+        uint32_t const t = _s1[lane] << 9;
+        _s2[lane] ^= _s0[lane];
+        _s3[lane] ^= _s1[lane];
+        _s1[lane] ^= _s2[lane];
+        _s0[lane] ^= _s3[lane];
+        _s2[lane] ^= t;
+        _s3[lane] = rotl(_s3[lane], 11);
+    }
+}
+
+auto Generator::next_u32() -> uint32_t
+{
+    if (_buffer_position == lanes)
+    {
+        next_block(_buffer);
+        _buffer_position = 0;
+    }
+    return _buffer[_buffer_position++];
+}
+
+auto Generator::uniform(float min, float max) -> float
+{
+    return min + (max - min) * to_unit_float(next_u32());
+}
+
+void Generator::fill(std::span<float> values, float min, float max)
+{
+    float const range = max - min;
+    size_t      i     = 0;
+    for (std::array<uint32_t, lanes> block{}; i + lanes <= values.size(); i += lanes)
+    {
+        next_block(block);
+        for (size_t lane = 0; lane < lanes; ++lane)
+            values[i + lane] = min + range * to_unit_float(block[lane]);
+    }
+    for (; i < values.size(); ++i)
+        values[i] = uniform(min, max);
+}
+
+auto Generator::state() const -> State
+{
+    return State{
+        .s0              = _s0,
+        .s1              = _s1,
+        .s2              = _s2,
+        .s3              = _s3,
+        .buffer          = _buffer,
+        .buffer_position = static_cast<uint32_t>(_buffer_position),
+    };
+}
+
+void Generator::set_state(State const& state)
+{
+    _s0              = state.s0;
+    _s1              = state.s1;
+    _s2              = state.s2;
+    _s3              = state.s3;
+    _buffer          = state.buffer;
+    _buffer_position = std::min<size_t>(state.buffer_position, lanes);
+}
+
+static std::atomic<uint64_t> global_seed{std::random_device{}()};
+static std::atomic<uint64_t> global_seed_version{0};
+static std::atomic<uint64_t> next_stream{0};
+
+void set_seed(uint64_t seed)
+{
+    global_seed = seed;
+    next_stream = 0;
+    ++global_seed_version;
+}
+
+auto seed() -> uint64_t
+{
+    return global_seed;
+}
+
+auto thread_generator() -> Generator&
+{
+    thread_local auto     generator    = Generator{0};
+    thread_local uint64_t seed_version = ~uint64_t{0};
+    if (seed_version != global_seed_version)
+    {
+        seed_version = global_seed_version;
+        generator    = Generator{global_seed, next_stream++};
+    }
+    return generator;
+}
+
+auto rand(float min, float max) -> float
+{
+    return thread_generator().uniform(min, max);
+}
+
+void rand_fill(std::span<float> values, float min, float max)
+{
+    thread_generator().fill(values, min, max);
+}
+
+} // namespace rng
@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace rng {
+
+/// xoshiro128+ generator running 8 independent lanes side by side.
+/// The lanes are stored as separate arrays (SoA), so bulk generation is a plain loop over the lanes that the compiler turns into SIMD instructions.
+class Generator {
+public:
+    static constexpr size_t lanes = 8;
+
+    /// Everything needed to continue the exact same sequence later, e.g. after saving it in a snapshot
+    struct State {
+        std::array<uint32_t, lanes> s0{};
+        std::array<uint32_t, lanes> s1{};
+        std::array<uint32_t, lanes> s2{};
+        std::array<uint32_t, lanes> s3{};
+        std::array<uint32_t, lanes> buffer{};
+        uint32_t                    buffer_position{};
+    };
+
+    /// Two generators with the same seed but different streams produce unrelated sequences.
+    explicit Generator(uint64_t seed, uint64_t stream = 0);
+
+    auto next_u32() -> uint32_t;
+    /// Uniform in [min, max)
+    auto uniform(float min, float max) -> float;
+    /// Fills `values` with uniform values in [min, max)
+    void fill(std::span<float> values, float min, float max);
+
+    auto state() const -> State;
+    void set_state(State const&);
+
+private:
+    void next_block(std::array<uint32_t, lanes>& out);
+
+private:
+    alignas(32) std::array<uint32_t, lanes> _s0{};
+    alignas(32) std::array<uint32_t, lanes> _s1{};
+    alignas(32) std::array<uint32_t, lanes> _s2{};
+    alignas(32) std::array<uint32_t, lanes> _s3{};
+
+    std::array<uint32_t, lanes> _buffer{}; // Values of the current block not consumed yet by next_u32()
+    size_t                      _buffer_position{lanes};
+};
+
+/// Reseeds the generators of all threads. After this call, the first thread to draw a number gets stream 0, the next one stream 1, etc.
+/// For reproducible parallel work, prefer giving each chunk of work its own `Generator{rng::seed(), chunk_index}`.
+void set_seed(uint64_t seed);
+auto seed() -> uint64_t;
+
+/// The generator of the calling thread
+auto thread_generator() -> Generator&;
+
+auto rand(float min, float max) -> float;
+void rand_fill(std::span<float> values, float min, float max);
+
+} // namespace rng
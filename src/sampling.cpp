@@ -0,0 +1,126 @@
+#include "sampling.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "glm/ext/scalar_constants.hpp"
+#include "rng.hpp"
+
+namespace sampling {
+
+glm::vec2 disk_polar(glm::vec2 u)
+{
+    float const radius = std::sqrt(u.x);
+    float const angle  = 2.f * glm::pi<float>() * u.y;
+    return radius * glm::vec2{std::cos(angle), std::sin(angle)};
+}
+
+glm::vec2 disk_concentric(glm::vec2 u)
+{
+    glm::vec2 const p = 2.f * u - 1.f; // Square [-1, 1]²
+    if (p.x == 0.f && p.y == 0.f)
+        return glm::vec2{0.f};
+
+    // Each concentric square is mapped to the circle of the same "radius"
+    float radius; // NOLINT(*init-variables)
+    float angle;  // NOLINT(*init-variables)
+    if (std::abs(p.x) > std::abs(p.y))
+    {
+        radius = p.x;
+        angle  = glm::pi<float>() / 4.f * (p.y / p.x);
+    }
+    else
+    {
+        radius = p.y;
+        angle  = glm::pi<float>() / 2.f - glm::pi<float>() / 4.f * (p.x / p.y);
+    }
+    return radius * glm::vec2{std::cos(angle), std::sin(angle)};
+}
+
+glm::vec2 annulus(glm::vec2 u, float inner_radius, float outer_radius)
+{
+    // Same as the polar disk, but the squared radius is uniform between the two bounds instead of between 0 and 1
+    float const radius = std::sqrt(glm::mix(inner_radius * inner_radius, outer_radius * outer_radius, u.x));
+    float const angle  = 2.f * glm::pi<float>() * u.y;
+    return radius * glm::vec2{std::cos(angle), std::sin(angle)};
+}
+
+glm::vec2 triangle(glm::vec2 u, glm::vec2 a, glm::vec2 b, glm::vec2 c)
+{
+    // Uniform in the parallelogram spanned by (b - a) and (c - a), with the half that is outside the triangle folded back inside
+    if (u.x + u.y > 1.f)
+        u = 1.f - u;
+    return a + u.x * (b - a) + u.y * (c - a);
+}
+
+Polyline::Polyline(std::vector<glm::vec2> points)
+    : _points{std::move(points)}
+{
+    assert(!_points.empty() && "A polyline needs at least one point.");
+    _cumulative_lengths.resize(_points.size());
+    _cumulative_lengths[0] = 0.f;
+    for (size_t i = 1; i < _points.size(); ++i)
+        _cumulative_lengths[i] = _cumulative_lengths[i - 1] + glm::distance(_points[i - 1], _points[i]);
+}
+
+glm::vec2 Polyline::at(float fraction) const
+{
+    float const target = fraction * length();
+    // First point whose cumulative length is greater than the target: the target lies on the segment that ends there
+    auto const it = std::upper_bound(_cumulative_lengths.begin() + 1, _cumulative_lengths.end(), target);
+    if (it == _cumulative_lengths.end())
+        return _points.back();
+    auto const  i              = static_cast<size_t>(it - _cumulative_lengths.begin());
+    float const segment_length = _cumulative_lengths[i] - _cumulative_lengths[i - 1];
+    float const t              = segment_length > 0.f ? (target - _cumulative_lengths[i - 1]) / segment_length : 0.f;
+    return glm::mix(_points[i - 1], _points[i], t);
+}
+
+glm::vec2 random_in_disk(glm::vec2 center, float radius)
+{
+    auto& generator = rng::thread_generator();
+    return center + radius * disk_polar({generator.uniform(0.f, 1.f), generator.uniform(0.f, 1.f)});
+}
+
+/// Draws the uniform numbers directly in the output arrays, then maps them in place
+template<typename Mapping>
+static void fill(std::span<float> xs, std::span<float> ys, Mapping&& mapping)
+{
+    assert(xs.size() == ys.size());
+    rng::rand_fill(xs, 0.f, 1.f);
+    rng::rand_fill(ys, 0.f, 1.f);
+    for (size_t i = 0; i < xs.size(); ++i)
+    {
+        glm::vec2 const p = mapping(glm::vec2{xs[i], ys[i]});
+        xs[i]             = p.x;
+        ys[i]             = p.y;
+    }
+}
+
+void fill_disk(std::span<float> xs, std::span<float> ys, glm::vec2 center, float radius)
+{
+    fill(xs, ys, [&](glm::vec2 u) { return center + radius * disk_polar(u); });
+}
+
+void fill_annulus(std::span<float> xs, std::span<float> ys, glm::vec2 center, float inner_radius, float outer_radius)
+{
+    fill(xs, ys, [&](glm::vec2 u) { return center + annulus(u, inner_radius, outer_radius); });
+}
+
+void fill_triangle(std::span<float> xs, std::span<float> ys, glm::vec2 a, glm::vec2 b, glm::vec2 c)
+{
+    fill(xs, ys, [&](glm::vec2 u) { return triangle(u, a, b, c); });
+}
+
+void fill_polyline(std::span<float> xs, std::span<float> ys, Polyline const& polyline)
+{
+    assert(xs.size() == ys.size());
+    rng::rand_fill(xs, 0.f, 1.f);
+    for (size_t i = 0; i < xs.size(); ++i)
+    {
+        glm::vec2 const p = polyline.at(xs[i]);
+        xs[i]             = p.x;
+        ys[i]             = p.y;
+    }
+}
+
+} // namespace sampling
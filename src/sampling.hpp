@@ -0,0 +1,45 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "glm/glm.hpp"
+
+/// Uniform sampling of shapes, without rejection: each sample costs a fixed number of random numbers,
+/// and batch versions can process whole SoA arrays in one loop.
+namespace sampling {
+
+// Mappings from a uniform point of [0, 1)² to a uniform point in the shape
+
+/// Unit disk, polar mapping. sqrt() compensates for the perimeter growing with the radius.
+glm::vec2 disk_polar(glm::vec2 u);
+/// Unit disk, Shirley–Chiu concentric mapping. Less distortion than the polar one, so it preserves the stratification of the input points.
+glm::vec2 disk_concentric(glm::vec2 u);
+/// Ring centered on the origin
+glm::vec2 annulus(glm::vec2 u, float inner_radius, float outer_radius);
+glm::vec2 triangle(glm::vec2 u, glm::vec2 a, glm::vec2 b, glm::vec2 c);
+
+/// Open polyline, sampled uniformly along its length
+class Polyline {
+public:
+    explicit Polyline(std::vector<glm::vec2> points);
+
+    /// Point at the given fraction of the length, in O(log(number of points))
+    glm::vec2 at(float fraction) const;
+    auto      length() const -> float { return _cumulative_lengths.back(); }
+
+private:
+    std::vector<glm::vec2> _points;
+    std::vector<float>     _cumulative_lengths; // _cumulative_lengths[i] is the length from the first point to _points[i]
+};
+
+// Random points, drawn from the thread's generator
+
+glm::vec2 random_in_disk(glm::vec2 center, float radius);
+
+// Batch versions: fill the SoA arrays xs and ys, which must have the same size
+
+void fill_disk(std::span<float> xs, std::span<float> ys, glm::vec2 center, float radius);
+void fill_annulus(std::span<float> xs, std::span<float> ys, glm::vec2 center, float inner_radius, float outer_radius);
+void fill_triangle(std::span<float> xs, std::span<float> ys, glm::vec2 a, glm::vec2 b, glm::vec2 c);
+void fill_polyline(std::span<float> xs, std::span<float> ys, Polyline const&);
+
+} // namespace sampling
@@ -0,0 +1,27 @@
+#include "segments.hpp"
+
+std::optional<IntersectionResult> intersect_segments(const glm::vec2& A, const glm::vec2& B,
+                                                     const glm::vec2& C, const glm::vec2& D)
+{
+    glm::vec2 u = B - A;
+    glm::vec2 v = D - C;
+    glm::vec2 w = C - A;
+    // Matrice M = [u, -v]
+    glm::mat2 M(u, -v);
+    float det = glm::determinant(M);
+
+    if (glm::abs(det) < 1e-6f)
+        return std::nullopt;  // Parallèles ou colinéaires
+
+    glm::mat2 invM = glm::inverse(M);
+    glm::vec2 ts = invM * w;
+    float t = ts.x;
+    float s = ts.y;
+
+    if (t >= 0.0f && t <= 1.0f && s >= 0.0f && s <= 1.0f) {
+        glm::vec2 P = A + t * u;
+        return IntersectionResult{P, t, s};
+    }
+
+    return std::nullopt;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <optional>
+#include "glm/glm.hpp"
+
+struct IntersectionResult {
+    glm::vec2 point;
+    float t, s;
+};
+
+/// Intersection of the segments [A, B] and [C, D]: point = A + t * (B - A) = C + s * (D - C)
+std::optional<IntersectionResult> intersect_segments(const glm::vec2& A, const glm::vec2& B,
+                                                     const glm::vec2& C, const glm::vec2& D);
+
+struct Segment
+{
+    glm::vec2 A;
+    glm::vec2 B;
+
+    glm::vec2 normal() const
+    {
+        glm::vec2 dir = B - A;
+        glm::vec2 n = glm::normalize(glm::vec2(-dir.y, dir.x)); // Perpendicular
+        return n;
+    }
+};
@@ -0,0 +1,93 @@
+#include "simulation.hpp"
+#include <cassert>
+#include <optional>
+#include "bezier.hpp"
+#include "opengl-framework/opengl-framework.hpp"
+
+static constexpr size_t max_bounces_per_step = 4; // A particle caught in a corner would otherwise bounce back and forth forever
+
+namespace simulation {
+
+void step(ParticlePool& particles, Curve const& curve, Parameters const& params, float dt, Scratch& scratch)
+{
+    assert(curve.kind() == CurveKind::Bezier && curve.control_points().size() == 4 && "The particles can only be attracted by a cubic Bézier curve");
+    auto const& control_points = curve.control_points();
+
+    auto const x    = particles.x();
+    auto const y    = particles.y();
+    auto const vx   = particles.vx();
+    auto const vy   = particles.vy();
+    auto const mass = particles.mass();
+    auto const age  = particles.age();
+
+    if (params.mutual_attraction)
+    {
+        gl::profiler::CpuScope const scope{"Mutual attraction"};
+        scratch.ax.assign(particles.size(), 0.f);
+        scratch.ay.assign(particles.size(), 0.f);
+        scratch.quad_tree.build(x, y, mass);
+        scratch.quad_tree.accumulate_accelerations(x, y, scratch.ax, scratch.ay, params.n_body);
+        for (size_t i = 0; i < particles.size(); ++i)
+        {
+            vx[i] += scratch.ax[i] * dt;
+            vy[i] += scratch.ay[i] * dt;
+        }
+    }
+
+    // In its own loop, so that the profiler can tell it apart from the forces
+    scratch.closest_t.resize(particles.size());
+    {
+        gl::profiler::CpuScope const scope{"Closest points on curve"};
+        for (size_t i = 0; i < particles.size(); ++i)
+            scratch.closest_t[i] = find_closest_t_on_bezier3(control_points[0], control_points[1], control_points[2], control_points[3], {x[i], y[i]});
+    }
+
+    gl::profiler::CpuScope const scope{"Forces"};
+    for (size_t i = 0; i < particles.size(); ++i)
+    {
+        glm::vec2 const position{x[i], y[i]};
+        glm::vec2 const acceleration = forces::acceleration(params.forces, {vx[i], vy[i]}, mass[i], curve.evaluate(scratch.closest_t[i]) - position);
+        glm::vec2       velocity     = glm::vec2{vx[i], vy[i]} + acceleration * dt;
+        glm::vec2       next         = position + velocity * dt;
+        // Bounces on the nearest obstacle that the path crosses, then checks the rest of the path from there, which might cross another one
+        glm::vec2 from          = position;
+        float     remaining_dt  = dt;
+        size_t    last_obstacle = params.obstacles.size(); // Not tested right after bouncing on it: the particle is on it
+        for (size_t bounce = 0;; ++bounce)
+        {
+            std::optional<IntersectionResult> hit{};
+            size_t                            hit_obstacle = 0;
+            for (size_t o = 0; o < params.obstacles.size(); ++o)
+            {
+                if (o == last_obstacle)
+                    continue;
+                auto const candidate = intersect_segments(from, next, params.obstacles[o].A, params.obstacles[o].B);
+                if (candidate && (!hit || candidate->t < hit->t))
+                {
+                    hit          = candidate;
+                    hit_obstacle = o;
+                }
+            }
+            if (!hit)
+                break;
+
+            velocity = glm::reflect(velocity, params.obstacles[hit_obstacle].normal());
+            if (bounce + 1 == max_bounces_per_step)
+            {
+                next = hit->point; // Stuck in a corner, it stops there until the next step
+                break;
+            }
+            remaining_dt *= 1.f - hit->t;
+            from          = hit->point;
+            next          = hit->point + velocity * remaining_dt; // Spends the rest of the step moving away from the obstacle
+            last_obstacle = hit_obstacle;
+        }
+        vx[i] = velocity.x;
+        vy[i] = velocity.y;
+        x[i]  = next.x;
+        y[i]  = next.y;
+        age[i] += dt;
+    }
+}
+
+} // namespace simulation
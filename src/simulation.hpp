@@ -0,0 +1,34 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "Curve.hpp"
+#include "ParticlePool.hpp"
+#include "barnes_hut.hpp"
+#include "forces.hpp"
+#include "segments.hpp"
+
+/// Simulation of the particles on the CPU. GpuParticleSystem does the same in a compute shader when it is available.
+namespace simulation {
+
+struct Parameters {
+    forces::Parameters forces{};
+    /// Mutual attraction between the particles (N-body gravity), approximated with a Barnes–Hut quadtree
+    bool                     mutual_attraction{false};
+    barnes_hut::Parameters   n_body{.theta = 0.5f};
+    /// The particles bounce on them. GpuParticleSystem ignores them. Must outlive the parameters.
+    std::span<Segment const> obstacles{};
+};
+
+/// Memory reused from one step to the next, so that stepping doesn't allocate once the number of particles has stabilized
+struct Scratch {
+    std::vector<float>   closest_t{}; // Parameter of the point of the curve closest to each particle
+    std::vector<float>   ax{};        // Accelerations
+    std::vector<float>   ay{};        // due to the mutual attraction
+    barnes_hut::QuadTree quad_tree{};
+};
+
+/// Attracts the particles towards the curve, which must be a single cubic Bézier, then moves them (semi-implicit Euler), bounces them on the obstacles and ages them.
+/// Doesn't kill the expired particles.
+void step(ParticlePool&, Curve const& curve, Parameters const&, float dt, Scratch&);
+
+} // namespace simulation
@@ -1,18 +1,14 @@
 #include "utils.hpp"
-#include <random>
+#include <vector>
+#include "glm/gtc/packing.hpp"
 #include "opengl-framework/opengl-framework.hpp"
+#include "rng.hpp"
 
 namespace utils {
 
-static auto& generator()
-{
-    thread_local std::default_random_engine gen{std::random_device{}()};
-    return gen;
-}
-
 float rand(float min, float max)
 {
-    return std::uniform_real_distribution<float>{min, max}(generator());
+    return rng::rand(min, max);
 }
 
 static auto make_square_mesh() -> gl::Mesh
@@ -90,6 +86,98 @@ void draw_disk(glm::vec2 position, float radius, glm::vec4 const& color)
     square_mesh.draw();
 }
 
+auto make_disk_instance(glm::vec2 position, float radius, glm::vec4 const& color) -> DiskInstance
+{
+    return DiskInstance{
+        .position = glm::packSnorm2x16(position / disk_instance_position_range),
+        .color    = glm::packUnorm4x8(color),
+        .radius   = glm::packHalf2x16(glm::vec2{radius}),
+    };
+}
+
+static auto make_disk_instances_mesh() -> gl::Mesh
+{
+    return gl::Mesh{gl::Mesh_Descriptor{
+        .vertex_buffers = {
+            gl::VertexBuffer_Descriptor{
+                .layout = {gl::VertexAttribute::Position2D(0), gl::VertexAttribute::UV(1)},
+                .data   = {
+                    -1.f, -1.f, 0.f, 0.f, //
+                    +1.f, -1.f, 1.f, 0.f, //
+                    +1.f, +1.f, 1.f, 1.f, //
+                    -1.f, +1.f, 0.f, 1.f  //
+                }
+            },
+            gl::VertexBuffer_Descriptor{
+                .layout           = {gl::VertexAttribute::SNorm16Vec2(2), gl::VertexAttribute::UNorm8Vec4(3), gl::VertexAttribute::HalfVec2(4)},
+                .data             = std::span<DiskInstance const>{}, // Filled by draw_disks()
+                .instance_divisor = 1,
+            },
+        },
+        .index_buffer = {0, 1, 2, 0, 2, 3},
+    }};
+}
+
+static auto make_disk_instances_shader() -> gl::Shader
+{
+    return gl::Shader{
+        gl::Shader_Descriptor{
+            .vertex   = gl::ShaderSource::Code({R"GLSL(
+#version 410
+
+layout(location = 0) in vec2 in_position;
+layout(location = 1) in vec2 in_uv;
+layout(location = 2) in vec2 in_instance_position;
+layout(location = 3) in vec4 in_instance_color;
+layout(location = 4) in vec2 in_instance_radius;
+
+uniform float u_position_range;
+uniform float u_inverse_aspect_ratio;
+
+out vec2 v_uv;
+out vec4 v_color;
+
+void main()
+{
+    vec2 position = u_position_range * in_instance_position + in_instance_radius * in_position;
+
+    gl_Position = vec4(position * vec2(u_inverse_aspect_ratio, 1.), 0., 1.);
+    v_uv = in_uv;
+    v_color = in_instance_color;
+}
+)GLSL"}),
+            .fragment = gl::ShaderSource::Code({R"GLSL(
+#version 410
+
+out vec4 out_color;
+
+in vec2 v_uv;
+in vec4 v_color;
+
+void main()
+{
+    vec2 dir = v_uv - vec2(0.5);
+    if (dot(dir, dir) > 0.25)
+        discard;
+    out_color = v_color;
+}
+)GLSL"}),
+        }
+    };
+}
+
+void draw_disks(std::span<DiskInstance const> disks)
+{
+    static auto disks_mesh  = make_disk_instances_mesh();
+    static auto disk_shader = make_disk_instances_shader();
+
+    disks_mesh.set_vertex_buffer_data(1, disks);
+    disk_shader.bind();
+    disk_shader.set_uniform("u_position_range", disk_instance_position_range);
+    disk_shader.set_uniform("u_inverse_aspect_ratio", 1.f / gl::framebuffer_aspect_ratio());
+    disks_mesh.draw_instanced(disks.size());
+}
+
 static auto make_line_shader() -> gl::Shader
 {
     return gl::Shader{
@@ -150,4 +238,76 @@ void draw_line(glm::vec2 start, glm::vec2 end, float thickness, glm::vec4 const&
     line_mesh.draw();
 }
 
+static auto make_polyline_mesh() -> gl::Mesh
+{
+    return gl::Mesh{gl::Mesh_Descriptor{
+        .vertex_buffers = {
+            gl::VertexBuffer_Descriptor{
+                .layout = {gl::VertexAttribute::Position2D(0)},
+                .data   = std::span<glm::vec2 const>{}, // Filled by draw_polyline()
+            },
+        },
+        .topology = gl::PrimitiveTopology::TriangleStrip,
+    }};
+}
+
+static auto make_polyline_shader() -> gl::Shader
+{
+    return gl::Shader{
+        gl::Shader_Descriptor{
+            .vertex   = gl::ShaderSource::Code({R"GLSL(
+#version 410
+
+layout(location = 0) in vec2 in_position;
+
+uniform float u_inverse_aspect_ratio;
+
+void main()
+{
+    gl_Position = vec4(in_position * vec2(u_inverse_aspect_ratio, 1.), 0., 1.);
+}
+)GLSL"}),
+            .fragment = gl::ShaderSource::Code({R"GLSL(
+#version 410
+
+out vec4 out_color;
+uniform vec4 u_color;
+
+void main()
+{
+    out_color = u_color;
+}
+)GLSL"}),
+        }
+    };
+}
+
+void draw_polyline(std::span<glm::vec2 const> points, float thickness, glm::vec4 const& color)
+{
+    static auto polyline_mesh   = make_polyline_mesh();
+    static auto polyline_shader = make_polyline_shader();
+    static auto strip           = std::vector<glm::vec2>{};
+    if (points.size() < 2)
+        return;
+
+    // Two vertices per point, on each side of the line. The direction at a point is the average of the directions of the segments around it, so that consecutive segments join without gaps.
+    strip.resize(2 * points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        glm::vec2 const previous  = points[i == 0 ? 0 : i - 1];
+        glm::vec2 const next      = points[i + 1 == points.size() ? i : i + 1];
+        glm::vec2 const direction = next - previous;
+        float const     length    = glm::length(direction);
+        glm::vec2 const normal    = length > 0.f ? glm::vec2{-direction.y, direction.x} / length : glm::vec2{0.f};
+        strip[2 * i]              = points[i] + normal * thickness * 0.5f;
+        strip[2 * i + 1]          = points[i] - normal * thickness * 0.5f;
+    }
+
+    polyline_mesh.set_vertex_buffer_data(0, strip);
+    polyline_shader.bind();
+    polyline_shader.set_uniform("u_inverse_aspect_ratio", 1.f / gl::framebuffer_aspect_ratio());
+    polyline_shader.set_uniform("u_color", color);
+    polyline_mesh.draw();
+}
+
 } // namespace utils
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <span>
 #include "glm/glm.hpp"
 
 namespace utils {
@@ -6,5 +8,22 @@ namespace utils {
 float rand(float min, float max);
 void  draw_disk(glm::vec2 position, float radius, glm::vec4 const& color);
 void  draw_line(glm::vec2 start, glm::vec2 end, float thickness, glm::vec4 const& color);
+/// Draws all the segments between consecutive points in a single draw call
+void  draw_polyline(std::span<glm::vec2 const> points, float thickness, glm::vec4 const& color);
+
+/// Positions of disk instances are stored in [-disk_instance_position_range, disk_instance_position_range]. Positions outside of it are clamped.
+static constexpr float disk_instance_position_range = 4.f;
+
+/// A disk drawn by draw_disks(), packed in 12 bytes instead of the 28 it would take with floats
+struct DiskInstance {
+    uint32_t position; // 2 x snorm16, in units of disk_instance_position_range
+    uint32_t color;    // 4 x unorm8, RGBA
+    uint32_t radius;   // 2 x half float, along x and y
+};
+static_assert(sizeof(DiskInstance) == 12);
+
+auto make_disk_instance(glm::vec2 position, float radius, glm::vec4 const& color) -> DiskInstance;
+/// Draws all the disks in a single draw call
+void draw_disks(std::span<DiskInstance const> disks);
 
 } // namespace utils
\ No newline at end of file